@@ -0,0 +1,71 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef benchmark_h
+#define benchmark_h
+
+#include <QElapsedTimer>
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+
+// Keeps the compiler from optimizing away a value computed by a benchmark.
+template <typename T>
+inline void keepValue(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Runs fn() with a doubling iteration count until a round takes at least
+// minTimeNs, then prints one JSON line with the result of that round.
+// Benchmarks that count allocations pass their counter, and the line has
+// the allocations per operation as well.
+template <typename F>
+void runBenchmark(const char *name, F &&fn, qint64 minTimeNs = 200000000,
+                  const std::atomic<uint64_t> *allocations = nullptr)
+{
+    QElapsedTimer timer;
+    qint64 iterations = 1;
+    qint64 elapsed;
+    uint64_t allocated;
+
+    fn(); // warm up
+
+    for (;;) {
+        allocated = allocations ? allocations->load(std::memory_order_relaxed) : 0;
+        timer.start();
+        for (qint64 i = 0; i < iterations; ++i)
+            fn();
+        elapsed = timer.nsecsElapsed();
+        if (allocations)
+            allocated = allocations->load(std::memory_order_relaxed) - allocated;
+        if (elapsed >= minTimeNs)
+            break;
+        iterations *= 2;
+    }
+
+    if (allocations)
+        printf("{\"benchmark\":\"%s\",\"iterations\":%lld,\"ns_per_op\":%.1f,\"allocs_per_op\":%.2f}\n",
+               name, static_cast<long long>(iterations), static_cast<double>(elapsed) / iterations,
+               static_cast<double>(allocated) / iterations);
+    else
+        printf("{\"benchmark\":\"%s\",\"iterations\":%lld,\"ns_per_op\":%.1f}\n",
+               name, static_cast<long long>(iterations), static_cast<double>(elapsed) / iterations);
+    fflush(stdout);
+}
+
+#endif
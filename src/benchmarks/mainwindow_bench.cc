@@ -0,0 +1,459 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+// Times the MainWindow update paths on synthetic info records, for graphs
+// of three sizes. Every update is of an object the window already shows,
+// as for a change event, and cycles through the objects of its facility.
+//
+// The window is the program's own: its main() brings it up against the
+// libpulse stand-in (pulseshim.cc) with an empty graph, so that the peak
+// streams the updates create have a context, and the benchmarks run once
+// the window is connected. Allocations are counted by interposing malloc()
+// and friends, which Qt, glib and operator new all end up in.
+
+#include "benchmark.h"
+#include "../pavucontrol.h"
+#include "../mainwindow.h"
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QTimer>
+#include <deque>
+#include <vector>
+#include <string.h>
+
+int pavucontrol_main(int argc, char *argv[]);
+
+static std::atomic<uint64_t> allocations;
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t size);
+
+void *malloc(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+
+} // extern "C"
+
+namespace {
+
+struct GraphSize {
+    const char *name;
+    int cards;
+    int sinks;          // each with its monitor source
+    int sources;
+    int clients;
+    int sinkInputs;     // spread over the sinks and clients
+    int sourceOutputs;  // spread over the sources and clients
+};
+
+const GraphSize graphSizes[] = {
+    { "small",  1,  2,  1,   5,   10,   2 },
+    { "medium", 4,  8,  4,  50,  200,  20 },
+    { "large",  8, 32, 16, 200, 2000, 100 },
+};
+
+// The info records of one graph, and everything they point to.
+class SyntheticGraph {
+public:
+    explicit SyntheticGraph(const GraphSize &size);
+    ~SyntheticGraph();
+
+    std::vector<pa_card_info> cards;
+    std::vector<pa_sink_info> sinks;
+    // the sources, then the monitors of the sinks
+    std::vector<pa_source_info> sources;
+    std::vector<pa_client_info> clients;
+    std::vector<pa_sink_input_info> sinkInputs;
+    std::vector<pa_source_output_info> sourceOutputs;
+    pa_server_info server;
+
+private:
+    const char *keep(const QByteArray &s) {
+        mStrings.push_back(s);
+        return mStrings.back().constData();
+    }
+
+    pa_proplist *proplist(const char *key, const char *value, const char *key2 = nullptr, const char *value2 = nullptr) {
+        pa_proplist *p = pa_proplist_new();
+        pa_proplist_sets(p, key, value);
+        if (key2)
+            pa_proplist_sets(p, key2, value2);
+        mProplists.push_back(p);
+        return p;
+    }
+
+    void addCard(uint32_t index);
+
+    /* deques, so that what the records point to stays where it is */
+    std::deque<QByteArray> mStrings;
+    std::vector<pa_proplist*> mProplists;
+    std::deque<pa_card_profile_info> mProfiles;
+    std::deque<pa_card_profile_info2> mProfiles2;
+    std::deque<std::vector<pa_card_profile_info2*> > mProfileLists;
+    std::deque<pa_card_port_info> mCardPorts;
+    std::deque<std::vector<pa_card_port_info*> > mCardPortLists;
+    pa_sink_port_info mSinkPorts[2];
+    pa_sink_port_info *mSinkPortList[2];
+    pa_source_port_info mSourcePort;
+    pa_source_port_info *mSourcePortList[1];
+};
+
+void SyntheticGraph::addCard(uint32_t index) {
+    static const struct {
+        const char *name;
+        const char *description;
+        uint32_t sinks;
+        uint32_t sources;
+    } profiles[] = {
+        { "output:analog-stereo+input:analog-stereo", "Analog Stereo Duplex", 1, 1 },
+        { "output:hdmi-stereo", "Digital Stereo (HDMI) Output", 1, 0 },
+        { "off", "Off", 0, 0 },
+    };
+    static const struct {
+        const char *name;
+        const char *description;
+        int direction;
+        int available;
+        // the profiles it belongs to, as bits
+        unsigned profiles;
+    } ports[] = {
+        { "analog-output-speaker", "Speakers", PA_DIRECTION_OUTPUT, PA_PORT_AVAILABLE_UNKNOWN, 1 },
+        { "analog-output-headphones", "Headphones", PA_DIRECTION_OUTPUT, PA_PORT_AVAILABLE_NO, 1 },
+        { "hdmi-output-0", "HDMI / DisplayPort", PA_DIRECTION_OUTPUT, PA_PORT_AVAILABLE_YES, 2 },
+        { "analog-input-mic", "Microphone", PA_DIRECTION_INPUT, PA_PORT_AVAILABLE_NO, 1 },
+    };
+
+    pa_card_info card;
+    memset(&card, 0, sizeof(card));
+    card.index = index;
+    card.name = keep("alsa_card.pci-0000_00_1f." + QByteArray::number(index));
+    card.proplist = proplist(PA_PROP_DEVICE_DESCRIPTION, keep("Built-in Audio " + QByteArray::number(index)),
+                             PA_PROP_DEVICE_ICON_NAME, "audio-card-pci");
+
+    std::vector<pa_card_profile_info2*> cardProfiles;
+    for (const auto &p : profiles) {
+        pa_card_profile_info2 profile;
+        memset(&profile, 0, sizeof(profile));
+        profile.name = p.name;
+        profile.description = p.description;
+        profile.n_sinks = p.sinks;
+        profile.n_sources = p.sources;
+        profile.priority = 100 * p.sinks + 10 * p.sources;
+        profile.available = 1;
+        mProfiles2.push_back(profile);
+        cardProfiles.push_back(&mProfiles2.back());
+    }
+    cardProfiles.push_back(nullptr);
+    mProfileLists.push_back(cardProfiles);
+    card.profiles2 = mProfileLists.back().data();
+    card.active_profile2 = cardProfiles[0];
+
+    pa_card_profile_info active;
+    memset(&active, 0, sizeof(active));
+    active.name = profiles[0].name;
+    active.description = profiles[0].description;
+    mProfiles.push_back(active);
+    card.active_profile = &mProfiles.back();
+
+    std::vector<pa_card_port_info*> cardPorts;
+    for (const auto &p : ports) {
+        std::vector<pa_card_profile_info2*> portProfiles;
+        for (unsigned k = 0; k < sizeof(profiles) / sizeof(profiles[0]); ++k) {
+            if (p.profiles & (1u << k))
+                portProfiles.push_back(cardProfiles[k]);
+        }
+        portProfiles.push_back(nullptr);
+        mProfileLists.push_back(portProfiles);
+
+        pa_card_port_info port;
+        memset(&port, 0, sizeof(port));
+        port.name = p.name;
+        port.description = p.description;
+        port.priority = 100;
+        port.available = p.available;
+        port.direction = p.direction;
+        port.profiles2 = mProfileLists.back().data();
+        mCardPorts.push_back(port);
+        cardPorts.push_back(&mCardPorts.back());
+    }
+    mCardPortLists.push_back(cardPorts);
+    card.n_ports = cardPorts.size();
+    card.ports = mCardPortLists.back().data();
+
+    cards.push_back(card);
+}
+
+SyntheticGraph::SyntheticGraph(const GraphSize &size) {
+    pa_channel_map stereo;
+    pa_cvolume volume;
+    pa_channel_map_init_stereo(&stereo);
+    pa_cvolume_set(&volume, stereo.channels, PA_VOLUME_NORM);
+
+    memset(mSinkPorts, 0, sizeof(mSinkPorts));
+    mSinkPorts[0].name = "analog-output-speaker";
+    mSinkPorts[0].description = "Speakers";
+    mSinkPorts[0].priority = 10000;
+    mSinkPorts[0].available = PA_PORT_AVAILABLE_UNKNOWN;
+    mSinkPorts[1].name = "analog-output-headphones";
+    mSinkPorts[1].description = "Headphones";
+    mSinkPorts[1].priority = 9900;
+    mSinkPorts[1].available = PA_PORT_AVAILABLE_NO;
+    mSinkPortList[0] = &mSinkPorts[0];
+    mSinkPortList[1] = &mSinkPorts[1];
+
+    memset(&mSourcePort, 0, sizeof(mSourcePort));
+    mSourcePort.name = "analog-input-mic";
+    mSourcePort.description = "Microphone";
+    mSourcePort.priority = 8700;
+    mSourcePort.available = PA_PORT_AVAILABLE_NO;
+    mSourcePortList[0] = &mSourcePort;
+
+    for (int i = 0; i < size.cards; ++i)
+        addCard(i);
+
+    /* the sources first, so that the monitors can follow them */
+    for (int i = 0; i < size.sources; ++i) {
+        pa_source_info s;
+        memset(&s, 0, sizeof(s));
+        s.index = i;
+        s.name = keep("alsa_input.pci-0000_00_1f.analog-stereo." + QByteArray::number(i));
+        s.description = keep("Built-in Audio Analog Stereo " + QByteArray::number(i));
+        s.proplist = proplist(PA_PROP_DEVICE_ICON_NAME, "audio-input-microphone");
+        s.channel_map = stereo;
+        s.volume = volume;
+        s.flags = (pa_source_flags_t) (PA_SOURCE_HARDWARE | PA_SOURCE_DECIBEL_VOLUME | PA_SOURCE_HW_VOLUME_CTRL);
+        s.base_volume = PA_VOLUME_NORM;
+        s.card = i % size.cards;
+        s.monitor_of_sink = PA_INVALID_INDEX;
+        s.n_ports = 1;
+        s.ports = mSourcePortList;
+        s.active_port = &mSourcePort;
+        sources.push_back(s);
+    }
+
+    for (int i = 0; i < size.sinks; ++i) {
+        pa_sink_info s;
+        memset(&s, 0, sizeof(s));
+        s.index = i;
+        s.name = keep("alsa_output.pci-0000_00_1f.analog-stereo." + QByteArray::number(i));
+        s.description = keep("Built-in Audio Analog Stereo " + QByteArray::number(i));
+        s.proplist = proplist(PA_PROP_DEVICE_ICON_NAME, "audio-card-pci");
+        s.channel_map = stereo;
+        s.volume = volume;
+        s.flags = (pa_sink_flags_t) (PA_SINK_HARDWARE | PA_SINK_DECIBEL_VOLUME | PA_SINK_HW_VOLUME_CTRL);
+        s.base_volume = PA_VOLUME_NORM;
+        s.card = i % size.cards;
+        s.monitor_source = size.sources + i;
+        s.n_ports = 2;
+        s.ports = mSinkPortList;
+        s.active_port = &mSinkPorts[0];
+        sinks.push_back(s);
+
+        pa_source_info m;
+        memset(&m, 0, sizeof(m));
+        m.index = s.monitor_source;
+        m.name = keep(QByteArray(s.name) + ".monitor");
+        m.description = keep("Monitor of " + QByteArray(s.description));
+        m.proplist = proplist(PA_PROP_DEVICE_CLASS, "monitor");
+        m.channel_map = stereo;
+        m.volume = volume;
+        m.flags = PA_SOURCE_DECIBEL_VOLUME;
+        m.base_volume = PA_VOLUME_NORM;
+        m.card = s.card;
+        m.monitor_of_sink = s.index;
+        sources.push_back(m);
+    }
+
+    for (int i = 0; i < size.clients; ++i) {
+        pa_client_info c;
+        memset(&c, 0, sizeof(c));
+        c.index = i;
+        c.name = keep("Client " + QByteArray::number(i));
+        c.proplist = proplist(PA_PROP_APPLICATION_NAME, c.name);
+        clients.push_back(c);
+    }
+
+    for (int i = 0; i < size.sinkInputs; ++i) {
+        pa_sink_input_info s;
+        memset(&s, 0, sizeof(s));
+        s.index = i;
+        s.name = keep("Playback Stream " + QByteArray::number(i));
+        s.client = i % size.clients;
+        s.sink = i % size.sinks;
+        s.proplist = proplist(PA_PROP_APPLICATION_NAME, clients[s.client].name,
+                              PA_PROP_MEDIA_NAME, s.name);
+        s.channel_map = stereo;
+        s.volume = volume;
+        s.has_volume = 1;
+        s.volume_writable = 1;
+        sinkInputs.push_back(s);
+    }
+
+    for (int i = 0; i < size.sourceOutputs; ++i) {
+        pa_source_output_info s;
+        memset(&s, 0, sizeof(s));
+        s.index = i;
+        s.name = keep("Record Stream " + QByteArray::number(i));
+        s.client = i % size.clients;
+        s.source = i % size.sources;
+        s.proplist = proplist(PA_PROP_APPLICATION_NAME, clients[s.client].name,
+                              PA_PROP_MEDIA_NAME, s.name);
+        s.channel_map = stereo;
+        s.volume = volume;
+        s.has_volume = 1;
+        s.volume_writable = 1;
+        sourceOutputs.push_back(s);
+    }
+
+    memset(&server, 0, sizeof(server));
+    server.server_name = "pulseaudio";
+    server.default_sink_name = sinks[0].name;
+    server.default_source_name = sources[0].name;
+    server.channel_map = stereo;
+}
+
+SyntheticGraph::~SyntheticGraph() {
+    for (pa_proplist *p : mProplists)
+        pa_proplist_free(p);
+}
+
+/* a change for the update to apply, so that it is not the same every time */
+void nudge(pa_cvolume *volume, size_t n) {
+    pa_cvolume_set(volume, volume->channels, n & 1 ? PA_VOLUME_NORM / 2 : PA_VOLUME_NORM);
+}
+
+void benchmarkGraph(MainWindow *w, const GraphSize &size) {
+    SyntheticGraph g(size);
+
+    /* in the order of the initial enumeration */
+    for (const pa_card_info &i : g.cards)
+        w->updateCard(i);
+    for (const pa_sink_info &i : g.sinks)
+        w->updateSink(i);
+    for (const pa_source_info &i : g.sources)
+        w->updateSource(i);
+    for (const pa_client_info &i : g.clients)
+        w->updateClient(i);
+    for (const pa_sink_input_info &i : g.sinkInputs)
+        w->updateSinkInput(i);
+    for (const pa_source_output_info &i : g.sourceOutputs)
+        w->updateSourceOutput(i);
+    w->updateServer(g.server);
+    QCoreApplication::processEvents();
+
+    const QByteArray prefix = "mainwindow_" + QByteArray(size.name) + '/';
+    const qint64 minTime = 200000000;
+    size_t n = 0;
+
+    runBenchmark(QByteArray(prefix + "updateCard").constData(), [&]() {
+        w->updateCard(g.cards[n++ % g.cards.size()]);
+    }, minTime, &allocations);
+
+    runBenchmark(QByteArray(prefix + "updateSink").constData(), [&]() {
+        pa_sink_info &i = g.sinks[n % g.sinks.size()];
+        nudge(&i.volume, n++ / g.sinks.size());
+        w->updateSink(i);
+    }, minTime, &allocations);
+
+    runBenchmark(QByteArray(prefix + "updateSource").constData(), [&]() {
+        pa_source_info &i = g.sources[n % g.sources.size()];
+        nudge(&i.volume, n++ / g.sources.size());
+        w->updateSource(i);
+    }, minTime, &allocations);
+
+    runBenchmark(QByteArray(prefix + "updateSinkInput").constData(), [&]() {
+        pa_sink_input_info &i = g.sinkInputs[n % g.sinkInputs.size()];
+        nudge(&i.volume, n++ / g.sinkInputs.size());
+        w->updateSinkInput(i);
+    }, minTime, &allocations);
+
+    runBenchmark(QByteArray(prefix + "updateSourceOutput").constData(), [&]() {
+        pa_source_output_info &i = g.sourceOutputs[n % g.sourceOutputs.size()];
+        nudge(&i.volume, n++ / g.sourceOutputs.size());
+        w->updateSourceOutput(i);
+    }, minTime, &allocations);
+
+    runBenchmark(QByteArray(prefix + "updateClient").constData(), [&]() {
+        w->updateClient(g.clients[n++ % g.clients.size()]);
+    }, minTime, &allocations);
+
+    runBenchmark(QByteArray(prefix + "updateServer").constData(), [&]() {
+        g.server.default_sink_name = g.sinks[n++ % g.sinks.size()].name;
+        w->updateServer(g.server);
+    }, minTime, &allocations);
+
+    runBenchmark(QByteArray(prefix + "updateVolumeMeter_source").constData(), [&]() {
+        w->updateVolumeMeter(g.sources[n % g.sources.size()].index, PA_INVALID_INDEX, n & 1 ? 0.25 : 0.75);
+        n++;
+    }, minTime, &allocations);
+
+    runBenchmark(QByteArray(prefix + "updateVolumeMeter_sink_input").constData(), [&]() {
+        const pa_sink_input_info &i = g.sinkInputs[n % g.sinkInputs.size()];
+        w->updateVolumeMeter(g.sinks[i.sink].monitor_source, i.index, n & 1 ? 0.25 : 0.75);
+        n++;
+    }, minTime, &allocations);
+
+    w->removeAllWidgets();
+    QCoreApplication::processEvents();
+}
+
+/* runs in the program's QApplication constructor; the benchmarks wait for the connection */
+void startBenchmarks() {
+    QTimer *poll = new QTimer(QCoreApplication::instance());
+    QObject::connect(poll, &QTimer::timeout, [poll]() {
+        MainWindow *w = pvcApp->mainWindow();
+        if (!w || !w->notebook->isVisibleTo(w))
+            return;
+
+        poll->stop();
+        for (const GraphSize &size : graphSizes)
+            benchmarkGraph(w, size);
+        QCoreApplication::quit();
+    });
+    poll->start(10);
+}
+
+} // namespace
+
+Q_COREAPP_STARTUP_FUNCTION(startBenchmarks)
+
+int main(int argc, char *argv[]) {
+    Q_UNUSED(argc);
+
+    /* an empty graph, and nothing left behind in the user's settings */
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    qputenv("PULSESHIM_SCRIPT", "/dev/null");
+    QStandardPaths::setTestMode(true);
+
+    char newInstance[] = "--new-instance";
+    char *args[] = { argv[0], newInstance, nullptr };
+    return pavucontrol_main(2, args);
+}
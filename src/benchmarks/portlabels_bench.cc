@@ -0,0 +1,111 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+// Composes the port and profile labels of a card with 30 ports and
+// 40 profiles, the way updatePorts() and MainWindow::updateCard() used to
+// (a translation lookup and UTF-8 conversion per label) and with PortLabels.
+
+#include "benchmark.h"
+#include "../portlabels.h"
+#include <pulse/def.h>
+#include <QCoreApplication>
+#include <vector>
+#include <string.h>
+
+struct SyntheticPort {
+    QByteArray name;
+    QByteArray description;
+    int available;
+    bool internal;
+};
+
+struct SyntheticProfile {
+    QByteArray name;
+    QByteArray description;
+    bool unplugged;
+    bool available;
+};
+
+static QByteArray baselinePort(const SyntheticPort &p) {
+    QByteArray desc = p.description;
+
+    if (p.available == PA_PORT_AVAILABLE_YES)
+        desc += QCoreApplication::translate("MainWindow", " (plugged in)").toUtf8().constData();
+    else if (p.available == PA_PORT_AVAILABLE_NO) {
+        if (p.name == "analog-output-speaker" ||
+            p.name == "analog-input-microphone-internal")
+            desc += QCoreApplication::translate("MainWindow", " (unavailable)").toUtf8().constData();
+        else
+            desc += QCoreApplication::translate("MainWindow", " (unplugged)").toUtf8().constData();
+    }
+    return desc;
+}
+
+static QByteArray baselineProfile(const SyntheticProfile &p) {
+    QByteArray desc = p.description.constData();
+
+    if (p.unplugged)
+        desc += QCoreApplication::translate("MainWindow", " (unplugged)").toUtf8().constData();
+    if (!p.available)
+        desc += QCoreApplication::translate("MainWindow", " (unavailable)").toUtf8().constData();
+    return desc;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    PortLabels::init();
+
+    const int availability[] = { PA_PORT_AVAILABLE_YES, PA_PORT_AVAILABLE_NO, PA_PORT_AVAILABLE_UNKNOWN };
+    std::vector<SyntheticPort> ports;
+    for (int i = 0; i < 30; ++i) {
+        SyntheticPort p;
+        if (i == 0)
+            p.name = "analog-output-speaker";
+        else
+            p.name = QByteArray("hdmi-output-") + QByteArray::number(i);
+        p.description = QByteArray("HDMI / DisplayPort ") + QByteArray::number(i);
+        p.available = availability[i % 3];
+        p.internal = PortLabels::isInternalPort(p.name.constData());
+        ports.push_back(p);
+    }
+
+    std::vector<SyntheticProfile> profiles;
+    for (int i = 0; i < 40; ++i) {
+        SyntheticProfile p;
+        p.name = QByteArray("output:hdmi-stereo-extra") + QByteArray::number(i);
+        p.description = QByteArray("Digital Stereo (HDMI ") + QByteArray::number(i) + ") Output";
+        p.unplugged = i % 4 == 0;
+        p.available = i % 5 != 0;
+        profiles.push_back(p);
+    }
+
+    runBenchmark("card_labels_30x40/baseline", [&]() {
+        for (const auto &p : ports)
+            keepValue(baselinePort(p));
+        for (const auto &p : profiles)
+            keepValue(baselineProfile(p));
+    });
+
+    runBenchmark("card_labels_30x40/portlabels", [&]() {
+        for (const auto &p : ports)
+            keepValue(PortLabels::portDescription(p.description, p.available, p.internal));
+        for (const auto &p : profiles)
+            keepValue(PortLabels::profileDescription(p.description.constData(), p.unplugged, p.available));
+    });
+
+    return 0;
+}
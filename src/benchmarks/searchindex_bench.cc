@@ -0,0 +1,118 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+// Filters 1100 cards, devices and streams (from 300 clients) through the
+// SearchIndex, one keystroke per operation: typing a query and erasing it
+// again, each step followed by the matches() pass that
+// reallyUpdateDeviceVisibility() makes over all widgets. Also times a stream
+// being renamed while a query is active.
+
+#include "benchmark.h"
+#include "../searchindex.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <utility>
+#include <vector>
+
+static const char *const applications[] = {
+    "Firefox", "Spotify", "Chromium", "mpv", "Telegram Desktop", "Discord",
+    "VLC media player", "Rhythmbox", "OBS Studio", "Zoom", "Thunderbird", "Steam",
+};
+
+static const char *const media[] = {
+    "Playback", "AudioStream", "Music", "Voice call", "Notification", "Video",
+    "Recording", "Game", "Podcast episode", "Alert",
+};
+
+static QString field(const char *const *words, int n, int i) {
+    return QString::fromLatin1(words[i % n]) + QLatin1Char(' ') + QString::number(i);
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const int nApplications = sizeof(applications) / sizeof(applications[0]);
+    const int nMedia = sizeof(media) / sizeof(media[0]);
+
+    SearchIndex index;
+    std::vector<std::pair<SearchIndex::Kind, uint32_t> > entries;
+
+    auto add = [&](SearchIndex::Kind kind, uint32_t i, const QString &text, uint32_t client) {
+        index.set(kind, i, text, client);
+        entries.push_back(std::make_pair(kind, i));
+    };
+
+    for (uint32_t i = 0; i < 300; ++i)
+        index.setClientName(i, field(applications, nApplications, i));
+
+    for (uint32_t i = 0; i < 20; ++i)
+        add(SearchIndex::Card, i, QStringLiteral("Built-in Audio ") + QString::number(i)
+            + QStringLiteral("\nalsa_card.pci-0000_00_1f.") + QString::number(i), UINT32_MAX);
+    for (uint32_t i = 0; i < 40; ++i) {
+        add(SearchIndex::Sink, i, QStringLiteral("HDMI / DisplayPort ") + QString::number(i)
+            + QStringLiteral(" Output\nalsa_output.pci-0000_00_1f.hdmi-stereo-extra") + QString::number(i), UINT32_MAX);
+        add(SearchIndex::Source, i, QStringLiteral("Analog Input ") + QString::number(i)
+            + QStringLiteral("\nalsa_input.pci-0000_00_1f.analog-stereo") + QString::number(i), UINT32_MAX);
+    }
+    for (uint32_t i = 0; i < 800; ++i)
+        add(SearchIndex::SinkInput, i, field(media, nMedia, i) + QLatin1Char('\n')
+            + field(applications, nApplications, i) + QStringLiteral("\nmusic"), i % 300);
+    for (uint32_t i = 0; i < 200; ++i)
+        add(SearchIndex::SourceOutput, i, field(media, nMedia, i + 3) + QStringLiteral("\nphone"), i % 300);
+
+    /* Typing "spotify 42" and erasing it again, one keystroke per operation */
+    const QString typed = QStringLiteral("spotify 42");
+    QStringList keystrokes;
+    for (int i = 1; i <= typed.size(); ++i)
+        keystrokes << typed.left(i);
+    for (int i = typed.size() - 1; i >= 0; --i)
+        keystrokes << typed.left(i);
+
+    int keystroke = 0;
+    runBenchmark("search_1100/keystroke", [&]() {
+        index.setQuery(keystrokes.at(keystroke));
+        keystroke = (keystroke + 1) % keystrokes.size();
+
+        int matches = 0;
+        for (const auto &e : entries)
+            matches += index.matches(e.first, e.second);
+        keepValue(matches);
+    });
+
+    /* A query of fewer than three characters has no trigram to narrow it down */
+    bool flip = false;
+    runBenchmark("search_1100/keystroke_short", [&]() {
+        index.setQuery(flip ? QStringLiteral("mu") : QStringLiteral("ph"));
+        flip = !flip;
+
+        int matches = 0;
+        for (const auto &e : entries)
+            matches += index.matches(e.first, e.second);
+        keepValue(matches);
+    });
+
+    index.setQuery(QStringLiteral("music"));
+    int renamed = 0;
+    runBenchmark("search_1100/rename_stream", [&]() {
+        const uint32_t i = renamed % 800;
+        keepValue(index.set(SearchIndex::SinkInput, i, field(media, nMedia, renamed) + QLatin1Char('\n')
+                            + field(applications, nApplications, i), i % 300));
+        ++renamed;
+    });
+
+    return 0;
+}
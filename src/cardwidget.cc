@@ -23,37 +23,33 @@
 #endif
 
 #include "cardwidget.h"
+#include "choicelistmodel.h"
+#include "operationstats.h"
+#include "changehistory.h"
 
 /*** CardWidget ***/
 CardWidget::CardWidget(QWidget* parent) :
     QWidget(parent) {
     setupUi(this);
+    profileModel = new ChoiceListModel(this);
+    profileList->setModel(profileModel);
     connect(profileList, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &CardWidget::onProfileChange);
     connect(profileCB, &QAbstractButton::toggled, this, &CardWidget::onProfileCheck);
 }
 
 
 void CardWidget::prepareMenu() {
-    int idx = 0;
     const bool off = activeProfile == noInOutProfile;
 
-    profileList->clear();
-    /* Fill the ComboBox */
-    for (const auto & profile : profiles) {
-        QByteArray name = profile.first;
-        // skip the "off" profile
-        if (name == noInOutProfile)
-            continue;
-        QString desc = QString::fromUtf8(profile.second);
-        profileList->addItem(desc, name);
-        if (profile.first == activeProfile
-                || (off && profile.first == lastActiveProfile)
-                )
-        {
+    /* Update the ComboBox, skipping the "off" profile */
+    profileModel->setChoices(profiles, noInOutProfile);
+
+    const int idx = profileModel->row(off ? lastActiveProfile : activeProfile);
+    if (idx >= 0) {
+        if (idx != profileList->currentIndex())
             profileList->setCurrentIndex(idx);
-            lastActiveProfile = profile.first;
-        }
-        ++idx;
+        if (!off)
+            lastActiveProfile = activeProfile;
     }
 
     profileCB->setChecked(!off);
@@ -63,11 +59,15 @@ void CardWidget::changeProfile(const QByteArray & name)
 {
     pa_operation* o;
 
-    if (!(o = pa_context_set_card_profile_by_index(get_context(), index, name.constData(), nullptr, nullptr))) {
+    ChangeHistory::instance()->recordProfile(index, activeProfile, name);
+
+    OperationStats::Tracker t(OperationStats::SetProfile);
+    if (!(o = pa_context_set_card_profile_by_index(get_context(), index, name.constData(), t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_card_profile_by_index() failed").toUtf8().constData());
         return;
     }
 
+    t.attach(o);
     pa_operation_unref(o);
 }
 
@@ -22,9 +22,12 @@
 #define cardwidget_h
 
 #include "pavucontrol.h"
+#include "profileportmatrix.h"
 #include "ui_cardwidget.h"
 #include <QWidget>
 
+class ChoiceListModel;
+
 class PortInfo {
 public:
       QByteArray name;
@@ -33,7 +36,14 @@ public:
       int available;
       int direction;
       int64_t latency_offset;
-      std::vector<QByteArray> profiles;
+      bool internal;
+
+      bool operator==(const PortInfo &other) const {
+          return name == other.name && description == other.description
+              && priority == other.priority && available == other.available
+              && direction == other.direction && latency_offset == other.latency_offset
+              && internal == other.internal;
+      }
 };
 
 class CardWidget : public QWidget, public Ui::CardWidget {
@@ -47,6 +57,7 @@ public:
 
     std::vector< std::pair<QByteArray,QByteArray> > profiles;
     std::map<QByteArray, PortInfo> ports;
+    ProfilePortMatrix profilePorts;
     QByteArray activeProfile;
     QByteArray noInOutProfile;
     QByteArray lastActiveProfile;
@@ -60,6 +71,8 @@ protected:
     void onProfileChange(int active);
     void onProfileCheck(bool on);
 
+    ChoiceListModel *profileModel;
+
 };
 
 #endif
@@ -0,0 +1,245 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "changehistory.h"
+#include "operationstats.h"
+#include <pulse/rtclock.h>
+#include <string.h>
+
+/* volume changes closer together than this are one gesture, in ms */
+#define VOLUME_GESTURE 1000
+
+ChangeHistory *ChangeHistory::instance() {
+    static ChangeHistory history;
+    return &history;
+}
+
+ChangeHistory::ChangeHistory() :
+    mNext(0),
+    mUndoable(0),
+    mRedoable(0) {
+}
+
+ChangeHistory::Change &ChangeHistory::push(Kind kind, Target target, uint32_t index) {
+    Change &c = mRing[mNext];
+
+    c.kind = kind;
+    c.target = target;
+    c.index = index;
+    c.time = pa_rtclock_now();
+
+    mNext = (mNext + 1) % Capacity;
+    if (mUndoable < Capacity)
+        ++mUndoable;
+    mRedoable = 0;
+
+    return c;
+}
+
+bool ChangeHistory::storeName(Name *n, const QByteArray &s) {
+    if (s.size() > NameMax)
+        return false;
+
+    n->length = (uint8_t) s.size();
+    memcpy(n->data, s.constData(), s.size());
+    return true;
+}
+
+void ChangeHistory::recordVolume(Target target, uint32_t index, const pa_cvolume &before, const pa_cvolume &after) {
+    /* A gesture may move several sliders in turn (a volume group updates all of
+     * its members per step), so look through the whole run of recent volume
+     * changes for the one of this target, not just the last one. */
+    if (mRedoable == 0) {
+        const pa_usec_t now = pa_rtclock_now();
+        for (int i = 1; i <= mUndoable; i++) {
+            Change &c = mRing[(mNext + Capacity - i) % Capacity];
+            if (c.kind != Volume || now - c.time >= VOLUME_GESTURE * PA_USEC_PER_MSEC)
+                break;
+            if (c.target == target && c.index == index) {
+                c.volume.after = after;
+                c.time = now;
+                return;
+            }
+        }
+    }
+
+    Change &c = push(Volume, target, index);
+    c.volume.before = before;
+    c.volume.after = after;
+}
+
+void ChangeHistory::recordMute(Target target, uint32_t index, bool before, bool after) {
+    if (before == after)
+        return;
+
+    Change &c = push(Mute, target, index);
+    c.mute.before = before;
+    c.mute.after = after;
+}
+
+void ChangeHistory::recordMove(Target target, uint32_t index, uint32_t before, uint32_t after) {
+    if (before == after)
+        return;
+
+    Change &c = push(Move, target, index);
+    c.device.before = before;
+    c.device.after = after;
+}
+
+void ChangeHistory::recordPort(Target target, uint32_t index, const QByteArray &before, const QByteArray &after) {
+    if (before == after || before.size() > NameMax || after.size() > NameMax)
+        return;
+
+    Change &c = push(Port, target, index);
+    storeName(&c.name.before, before);
+    storeName(&c.name.after, after);
+}
+
+void ChangeHistory::recordProfile(uint32_t card, const QByteArray &before, const QByteArray &after) {
+    if (before == after || before.size() > NameMax || after.size() > NameMax)
+        return;
+
+    Change &c = push(Profile, Card, card);
+    storeName(&c.name.before, before);
+    storeName(&c.name.after, after);
+}
+
+void ChangeHistory::recordDefault(Target target, const QByteArray &before, const QByteArray &after) {
+    if (before == after || before.isEmpty() || before.size() > NameMax || after.size() > NameMax)
+        return;
+
+    Change &c = push(Default, target, PA_INVALID_INDEX);
+    storeName(&c.name.before, before);
+    storeName(&c.name.after, after);
+}
+
+bool ChangeHistory::undo() {
+    if (!mUndoable)
+        return false;
+
+    /* A change that could not be sent stays where it is, to be retried */
+    const int previous = (mNext + Capacity - 1) % Capacity;
+    if (!apply(mRing[previous], false))
+        return false;
+
+    mNext = previous;
+    --mUndoable;
+    ++mRedoable;
+    return true;
+}
+
+bool ChangeHistory::redo() {
+    if (!mRedoable)
+        return false;
+
+    if (!apply(mRing[mNext], true))
+        return false;
+
+    mNext = (mNext + 1) % Capacity;
+    ++mUndoable;
+    --mRedoable;
+    return true;
+}
+
+static OperationStats::Kind statsKind(uint8_t kind) {
+    static const OperationStats::Kind kinds[] = {
+        OperationStats::SetVolume,
+        OperationStats::SetMute,
+        OperationStats::MoveStream,
+        OperationStats::SetPort,
+        OperationStats::SetProfile,
+        OperationStats::SetDefault,
+    };
+    return kinds[kind];
+}
+
+bool ChangeHistory::apply(const Change &c, bool forward) {
+    pa_context *ctx = get_context();
+    pa_operation *o = nullptr;
+
+    if (!ctx || pa_context_get_state(ctx) != PA_CONTEXT_READY)
+        return false;
+
+    OperationStats::Tracker t(statsKind(c.kind));
+    switch (c.kind) {
+        case Volume: {
+            const pa_cvolume &volume = forward ? c.volume.after : c.volume.before;
+            if (c.target == Sink)
+                o = pa_context_set_sink_volume_by_index(ctx, c.index, &volume, t.callback(), t.userdata());
+            else if (c.target == Source)
+                o = pa_context_set_source_volume_by_index(ctx, c.index, &volume, t.callback(), t.userdata());
+            else if (c.target == SinkInput)
+                o = pa_context_set_sink_input_volume(ctx, c.index, &volume, t.callback(), t.userdata());
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            else if (c.target == SourceOutput)
+                o = pa_context_set_source_output_volume(ctx, c.index, &volume, t.callback(), t.userdata());
+#endif
+            break;
+        }
+        case Mute: {
+            const bool mute = forward ? c.mute.after : c.mute.before;
+            if (c.target == Sink)
+                o = pa_context_set_sink_mute_by_index(ctx, c.index, mute, t.callback(), t.userdata());
+            else if (c.target == Source)
+                o = pa_context_set_source_mute_by_index(ctx, c.index, mute, t.callback(), t.userdata());
+            else if (c.target == SinkInput)
+                o = pa_context_set_sink_input_mute(ctx, c.index, mute, t.callback(), t.userdata());
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            else if (c.target == SourceOutput)
+                o = pa_context_set_source_output_mute(ctx, c.index, mute, t.callback(), t.userdata());
+#endif
+            break;
+        }
+        case Move: {
+            const uint32_t device = forward ? c.device.after : c.device.before;
+            if (c.target == SinkInput)
+                o = pa_context_move_sink_input_by_index(ctx, c.index, device, t.callback(), t.userdata());
+            else if (c.target == SourceOutput)
+                o = pa_context_move_source_output_by_index(ctx, c.index, device, t.callback(), t.userdata());
+            break;
+        }
+        case Port:
+        case Profile:
+        case Default: {
+            const Name &n = forward ? c.name.after : c.name.before;
+            const QByteArray name(n.data, n.length);
+
+            if (c.kind == Profile)
+                o = pa_context_set_card_profile_by_index(ctx, c.index, name.constData(), t.callback(), t.userdata());
+            else if (c.kind == Default && c.target == Sink)
+                o = pa_context_set_default_sink(ctx, name.constData(), t.callback(), t.userdata());
+            else if (c.kind == Default)
+                o = pa_context_set_default_source(ctx, name.constData(), t.callback(), t.userdata());
+            else if (c.target == Sink)
+                o = pa_context_set_sink_port_by_index(ctx, c.index, name.constData(), t.callback(), t.userdata());
+            else if (c.target == Source)
+                o = pa_context_set_source_port_by_index(ctx, c.index, name.constData(), t.callback(), t.userdata());
+            break;
+        }
+    }
+
+    if (!o)
+        return false;
+
+    t.attach(o);
+    pa_operation_unref(o);
+    return true;
+}
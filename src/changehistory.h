@@ -0,0 +1,106 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef changehistory_h
+#define changehistory_h
+
+#include "pavucontrol.h"
+#include <QByteArray>
+
+// The changes made from this window, for undo and redo. Every change is kept
+// as a small fixed-size record of the values before and after it, in a ring
+// buffer that overwrites its oldest entries, so recording allocates nothing
+// and the memory used stays the same however long the session runs.
+//
+// Successive volume changes of the same target within VOLUME_GESTURE ms, as
+// made by a slider drag, are folded into one record, also when a group slider
+// interleaves the changes of its members. Port, profile and device
+// names longer than NameMax bytes are not recorded.
+//
+// Undoing issues the inverse operation directly; the widgets follow the
+// server's change events as usual.
+class ChangeHistory {
+public:
+    enum Target {
+        Sink,
+        Source,
+        SinkInput,
+        SourceOutput,
+        Card,
+    };
+
+    static constexpr int Capacity = 128;
+    static constexpr int NameMax = 95;
+
+    static ChangeHistory *instance();
+
+    void recordVolume(Target target, uint32_t index, const pa_cvolume &before, const pa_cvolume &after);
+    void recordMute(Target target, uint32_t index, bool before, bool after);
+    void recordMove(Target target, uint32_t index, uint32_t before, uint32_t after);
+    void recordPort(Target target, uint32_t index, const QByteArray &before, const QByteArray &after);
+    void recordProfile(uint32_t card, const QByteArray &before, const QByteArray &after);
+    // target is Sink or Source
+    void recordDefault(Target target, const QByteArray &before, const QByteArray &after);
+
+    bool canUndo() const { return mUndoable > 0; }
+    bool canRedo() const { return mRedoable > 0; }
+    // false if there was nothing to undo or redo, or it could not be sent;
+    // in that case the history is left as it was
+    bool undo();
+    bool redo();
+
+private:
+    ChangeHistory();
+
+    enum Kind : uint8_t {
+        Volume,
+        Mute,
+        Move,
+        Port,
+        Profile,
+        Default,
+    };
+
+    struct Name {
+        uint8_t length;
+        char data[NameMax];
+    };
+
+    struct Change {
+        Kind kind;
+        uint8_t target;
+        uint32_t index;
+        pa_usec_t time;
+        union {
+            struct { pa_cvolume before, after; } volume;
+            struct { bool before, after; } mute;
+            struct { uint32_t before, after; } device;
+            struct { Name before, after; } name;
+        };
+    };
+
+    Change &push(Kind kind, Target target, uint32_t index);
+    static bool storeName(Name *n, const QByteArray &s);
+    bool apply(const Change &c, bool forward);
+
+    Change mRing[Capacity];
+    int mNext;      // where the next change is recorded
+    int mUndoable;  // the changes before mNext
+    int mRedoable;  // the undone changes from mNext on
+};
+
+#endif
@@ -42,9 +42,31 @@ static inline pa_volume_t percent2PaVolume(int percent)
     return PA_VOLUME_MUTED + qRound(static_cast<double>(percent) / 100 * PA_VOLUME_NORM);
 }
 
+/* The volume label font and width only depend on the application font,
+ * so compute them once instead of for every channel of every widget */
+static void volumeLabelMetrics(const QFont &base, QFont *font, int *width)
+{
+    static QFont lastBase, lastFont;
+    static int lastWidth = -1;
+
+    if (lastWidth < 0 || base != lastBase) {
+        // make the info font smaller
+        lastFont = base;
+        if (lastFont.pixelSize() == -1)
+            lastFont.setPointSizeF(lastFont.pointSizeF() * 0.8);
+        else
+            lastFont.setPixelSize(qRound(static_cast<double>(lastFont.pixelSize()) * 0.8));
+        lastWidth = QFontMetrics{lastFont}.size(Qt::TextSingleLine, QStringLiteral("100%(-99.99dB)")).width();
+        lastBase = base;
+    }
+
+    *font = lastFont;
+    *width = lastWidth;
+}
+
 /*** ChannelWidget ***/
 
-Channel::Channel(QGridLayout* parent) :
+Channel::Channel(QGridLayout* parent, int row) :
     QObject(parent),
     can_decibel(false),
     volumeScaleEnabled(true),
@@ -54,19 +76,17 @@ Channel::Channel(QGridLayout* parent) :
     volumeScale = new QSlider(Qt::Horizontal, nullptr);
     volumeLabel = new QLabel(nullptr);
 
-    const int row = parent->rowCount();
+    if (row < 0)
+        row = parent->rowCount();
     parent->addWidget(channelLabel, row, 0);
     parent->addWidget(volumeScale, row, 1);
     parent->addWidget(volumeLabel, row, 2);
 
-    // make the info font smaller
-    QFont label_font = volumeLabel->font();
-    if (label_font.pixelSize() == -1)
-        label_font.setPointSizeF(label_font.pointSizeF() * 0.8);
-    else
-        label_font.setPixelSize(qRound(static_cast<double>(label_font.pixelSize()) * 0.8));
+    QFont label_font;
+    int label_width;
+    volumeLabelMetrics(volumeLabel->font(), &label_font, &label_width);
     volumeLabel->setFont(label_font);
-    volumeLabel->setFixedWidth(QFontMetrics{volumeLabel->font()}.size(Qt::TextSingleLine, QStringLiteral("100%(-99.99dB)")).width());
+    volumeLabel->setFixedWidth(label_width);
     volumeLabel->setAlignment(Qt::AlignHCenter);
     volumeLabel->setTextFormat(Qt::RichText);
 
@@ -75,7 +95,7 @@ Channel::Channel(QGridLayout* parent) :
     volumeScale->setPageStep(5);
     volumeScale->setTickInterval(paVolume2Percent(PA_VOLUME_NORM));
     volumeScale->setTickPosition(QSlider::TicksBelow);
-    volumeScale->setTracking(false);
+    volumeScale->setTracking(MinimalStreamWidget::liveVolumeTracking());
     setBaseVolume(PA_VOLUME_NORM);
 
     connect(volumeScale, &QSlider::valueChanged, this, &Channel::onVolumeScaleValueChanged);
@@ -111,6 +131,11 @@ void Channel::setEnabled(bool enabled)
     volumeLabel->setEnabled(enabled);
 }
 
+void Channel::setTracking(bool tracking)
+{
+    volumeScale->setTracking(tracking);
+}
+
 void Channel::onVolumeScaleValueChanged(int value) {
 
     if (!volumeScaleEnabled)
@@ -32,11 +32,12 @@ class MinimalStreamWidget;
 class Channel : public QObject {
     Q_OBJECT
 public:
-    Channel(QGridLayout* parent=nullptr);
+    Channel(QGridLayout* parent=nullptr, int row=-1);
 
     void setVolume(pa_volume_t volume);
     void setVisible(bool visible);
     void setEnabled(bool enabled);
+    void setTracking(bool tracking);
 
     int channel;
     MinimalStreamWidget *minimalStreamWidget;
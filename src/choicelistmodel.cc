@@ -0,0 +1,141 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "choicelistmodel.h"
+#include <algorithm>
+
+ChoiceListModel::ChoiceListModel(QObject *parent) :
+    QAbstractListModel(parent) {
+}
+
+int ChoiceListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(mEntries.size());
+}
+
+QVariant ChoiceListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(mEntries.size()))
+        return QVariant();
+
+    const Entry &e = mEntries[index.row()];
+    if (role == Qt::DisplayRole)
+        return e.label;
+    if (role == Qt::UserRole)
+        return e.name;
+    return QVariant();
+}
+
+int ChoiceListModel::find(const QByteArray &name, int from) const {
+    for (int i = from; i < static_cast<int>(mEntries.size()); ++i) {
+        if (mEntries[i].name == name)
+            return i;
+    }
+    return -1;
+}
+
+int ChoiceListModel::row(const QByteArray &name) const {
+    return find(name, 0);
+}
+
+void ChoiceListModel::relabel(int i, const QByteArray &description) {
+    Entry &e = mEntries[i];
+    if (e.description == description)
+        return;
+
+    e.description = description;
+    e.label = QString::fromUtf8(description);
+    const QModelIndex idx = index(i);
+    Q_EMIT dataChanged(idx, idx);
+}
+
+void ChoiceListModel::setChoices(const Choices &choices, const QByteArray &skip) {
+    auto skipped = [&](const QByteArray &name) {
+        return !skip.isNull() && name == skip;
+    };
+
+    /* The common case: the same entries in the same order */
+    size_t n = 0;
+    bool sameNames = true;
+    for (const auto &c : choices) {
+        if (skipped(c.first))
+            continue;
+        if (n >= mEntries.size() || mEntries[n].name != c.first) {
+            sameNames = false;
+            break;
+        }
+        ++n;
+    }
+    if (sameNames && n == mEntries.size()) {
+        int i = 0;
+        for (const auto &c : choices) {
+            if (!skipped(c.first))
+                relabel(i++, c.second);
+        }
+        return;
+    }
+
+    auto wanted = [&](const QByteArray &name) {
+        return !skipped(name)
+            && std::any_of(choices.begin(), choices.end(),
+                           [&](const Choices::value_type &c) { return c.first == name; });
+    };
+
+    /* Drop the rows that went away, as contiguous ranges */
+    for (int last = static_cast<int>(mEntries.size()) - 1; last >= 0; ) {
+        if (wanted(mEntries[last].name)) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !wanted(mEntries[first - 1].name))
+            --first;
+        beginRemoveRows(QModelIndex(), first, last);
+        mEntries.erase(mEntries.begin() + first, mEntries.begin() + last + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+
+    /* Walk the new list, moving, inserting and relabelling rows as needed */
+    int i = 0;
+    for (const auto &c : choices) {
+        if (skipped(c.first))
+            continue;
+
+        if (i < static_cast<int>(mEntries.size()) && mEntries[i].name == c.first) {
+            relabel(i++, c.second);
+            continue;
+        }
+
+        const int j = find(c.first, i + 1);
+        if (j >= 0) {
+            beginMoveRows(QModelIndex(), j, j, QModelIndex(), i);
+            Entry moved = std::move(mEntries[j]);
+            mEntries.erase(mEntries.begin() + j);
+            mEntries.insert(mEntries.begin() + i, std::move(moved));
+            endMoveRows();
+            relabel(i, c.second);
+        } else {
+            beginInsertRows(QModelIndex(), i, i);
+            mEntries.insert(mEntries.begin() + i, Entry{c.first, c.second, QString::fromUtf8(c.second)});
+            endInsertRows();
+        }
+        ++i;
+    }
+}
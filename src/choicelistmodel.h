@@ -0,0 +1,61 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef choicelistmodel_h
+#define choicelistmodel_h
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QString>
+#include <utility>
+#include <vector>
+
+// The model behind the port and profile combo boxes. Rows are keyed by
+// name (returned for Qt::UserRole) and show the description. setChoices()
+// diffs the new list against the current rows, so that only the rows that
+// were inserted, removed, moved or relabelled are signalled to the view and
+// an unchanged list emits nothing at all.
+class ChoiceListModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    typedef std::vector< std::pair<QByteArray,QByteArray> > Choices;
+
+    explicit ChoiceListModel(QObject *parent = nullptr);
+
+    // entries named skip are left out
+    void setChoices(const Choices &choices, const QByteArray &skip = QByteArray());
+
+    // the row of the entry called name, or -1
+    int row(const QByteArray &name) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Entry {
+        QByteArray name;
+        QByteArray description;
+        QString label;
+    };
+
+    int find(const QByteArray &name, int from) const;
+    void relabel(int i, const QByteArray &description);
+
+    std::vector<Entry> mEntries;
+};
+
+#endif
@@ -0,0 +1,511 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "commandscript.h"
+#include "operationbatch.h"
+#include "operationstats.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QRegExp>
+#include <QStringList>
+#include <stdio.h>
+
+static const char *const kindNames[] = {
+    "sink",
+    "source",
+    "sink-input",
+    "source-output",
+    "card",
+};
+
+static inline QString tr(const char *text) {
+    return QCoreApplication::translate("CommandScript", text);
+}
+
+static inline QString str(const QByteArray &s) {
+    return QString::fromUtf8(s);
+}
+
+bool CommandScript::tokenize(const QByteArray &line, QList<QByteArray> *args) {
+    QByteArray arg;
+    bool inArg = false;
+    bool quoted = false;
+
+    for (const char ch : line) {
+        if (ch == '"') {
+            quoted = !quoted;
+            inArg = true;
+        } else if (!quoted && (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')) {
+            if (inArg)
+                args->append(arg);
+            arg.clear();
+            inArg = false;
+        } else if (!quoted && !inArg && ch == '#') {
+            break;
+        } else {
+            arg += ch;
+            inArg = true;
+        }
+    }
+    if (inArg)
+        args->append(arg);
+
+    return !quoted;
+}
+
+/* "50%", "-6dB" and raw volumes are absolute, "+5%" and "-5%" relative */
+bool CommandScript::parseVolume(const QByteArray &s, bool *relative, qint64 *volume) {
+    bool ok;
+    *relative = false;
+
+    if (s.endsWith('%')) {
+        const double percent = s.left(s.size() - 1).toDouble(&ok);
+        *relative = s.startsWith('+') || s.startsWith('-');
+        *volume = qRound64(percent * PA_VOLUME_NORM / 100);
+        return ok && (*relative || percent >= 0);
+    }
+
+    if (s.endsWith("dB") || s.endsWith("db")) {
+        const double dB = s.left(s.size() - 2).toDouble(&ok);
+        *volume = pa_sw_volume_from_dB(dB);
+        return ok;
+    }
+
+    *volume = s.toLongLong(&ok);
+    return ok && *volume >= 0;
+}
+
+bool CommandScript::parseMute(const QByteArray &s, int *mute) {
+    const QByteArray v = s.toLower();
+    if (v == "on" || v == "yes" || v == "true" || v == "1")
+        *mute = 1;
+    else if (v == "off" || v == "no" || v == "false" || v == "0")
+        *mute = 0;
+    else if (v == "toggle")
+        *mute = -1;
+    else
+        return false;
+    return true;
+}
+
+pa_cvolume CommandScript::adjustVolume(const pa_cvolume &current, bool relative, qint64 volume) {
+    pa_cvolume v = current;
+    if (relative) {
+        for (int i = 0; i < v.channels; i++)
+            v.values[i] = (pa_volume_t) qBound<qint64>(PA_VOLUME_MUTED, v.values[i] + volume, PA_VOLUME_MAX);
+    } else {
+        pa_cvolume_scale(&v, (pa_volume_t) qMin<qint64>(volume, PA_VOLUME_MAX));
+    }
+    return v;
+}
+
+template <typename Call>
+static void issue(OperationBatch *batch, OperationStats::Kind kind, Call call) {
+    OperationStats::Tracker t(kind, batch->callback(), batch->userdata());
+    pa_operation *o = call(t.callback(), t.userdata());
+
+    if (o)
+        t.attach(o);
+    batch->add(o);
+}
+
+CommandScript *CommandScript::load(const QString &fileName, QString *error) {
+    QFile file;
+    bool opened;
+    if (fileName == QLatin1String("-")) {
+        opened = file.open(stdin, QIODevice::ReadOnly);
+    } else {
+        file.setFileName(fileName);
+        opened = file.open(QIODevice::ReadOnly);
+    }
+    if (!opened) {
+        *error = tr("Cannot read %1: %2").arg(fileName, file.errorString());
+        return nullptr;
+    }
+
+    CommandScript *script = new CommandScript;
+    if (!script->parse(file.readAll(), error)) {
+        delete script;
+        return nullptr;
+    }
+    return script;
+}
+
+bool CommandScript::parse(const QByteArray &script, QString *error) {
+    const QList<QByteArray> lines = script.split('\n');
+    QStringList errors;
+
+    for (int i = 0; i < lines.size(); i++) {
+        QList<QByteArray> args;
+        const bool ok = tokenize(lines[i], &args);
+        QString e;
+        if (!ok)
+            e = tr("unterminated quote");
+        else if (!args.isEmpty() && parseLine(i + 1, args, &e))
+            continue;
+        if (!e.isEmpty())
+            errors << tr("line %1: %2").arg(i + 1).arg(e);
+    }
+
+    *error = errors.join(QLatin1Char('\n'));
+    return errors.isEmpty();
+}
+
+bool CommandScript::parseLine(int line, const QList<QByteArray> &args, QString *error) {
+    static const struct {
+        const char *name;
+        Verb verb;
+        int args;
+    } verbs[] = {
+        { "volume", Volume, 4 },
+        { "mute", Mute, 4 },
+        { "move", Move, 4 },
+        { "default", Default, 3 },
+        { "profile", Profile, 4 },
+        { "port", Port, 4 },
+    };
+
+    Command cmd;
+    cmd.line = line;
+    cmd.relative = false;
+    cmd.volume = 0;
+    cmd.mute = 0;
+
+    int nargs = -1;
+    for (const auto &v : verbs) {
+        if (args[0] == v.name) {
+            cmd.verb = v.verb;
+            nargs = v.args;
+            break;
+        }
+    }
+    if (nargs < 0) {
+        *error = tr("unknown command \"%1\"").arg(str(args[0]));
+        return false;
+    }
+    if (args.size() != nargs) {
+        *error = tr("%1 takes %2 arguments").arg(str(args[0])).arg(nargs - 1);
+        return false;
+    }
+
+    int kind = -1;
+    for (int k = 0; k < KindCount; k++) {
+        if (args[1] == kindNames[k]) {
+            kind = k;
+            break;
+        }
+    }
+
+    bool valid;
+    switch (cmd.verb) {
+        case Volume:
+        case Mute:
+            valid = kind >= 0 && kind != Card;
+#if !HAVE_SOURCE_OUTPUT_VOLUMES
+            /* the server cannot change those of recording streams */
+            valid = valid && kind != SourceOutput;
+#endif
+            break;
+        case Move:
+            valid = kind == SinkInput || kind == SourceOutput;
+            break;
+        case Default:
+        case Port:
+            valid = kind == Sink || kind == Source;
+            break;
+        case Profile:
+        default:
+            valid = kind == Card;
+            break;
+    }
+    if (!valid) {
+        *error = tr("%1 does not apply to \"%2\"").arg(str(args[0]), str(args[1]));
+        return false;
+    }
+
+    cmd.kind = static_cast<Kind>(kind);
+    cmd.target = args[2];
+    if (nargs > 3)
+        cmd.argument = args[3];
+
+    if (cmd.verb == Volume && !parseVolume(cmd.argument, &cmd.relative, &cmd.volume)) {
+        *error = tr("invalid volume \"%1\"").arg(str(cmd.argument));
+        return false;
+    }
+    if (cmd.verb == Mute && !parseMute(cmd.argument, &cmd.mute)) {
+        *error = tr("invalid mute state \"%1\"").arg(str(cmd.argument));
+        return false;
+    }
+
+    mCommands.append(cmd);
+    return true;
+}
+
+void CommandScript::store(Kind kind, uint32_t index, const char *name, pa_proplist *proplist,
+                          const pa_cvolume *volume, bool mute) {
+    Object &o = mObjects[kind][index];
+    o.index = index;
+    o.name = name;
+    o.proplist = QSharedPointer<pa_proplist>(pa_proplist_copy(proplist), pa_proplist_free);
+    if (volume)
+        o.volume = *volume;
+    else
+        pa_cvolume_init(&o.volume);
+    o.mute = mute;
+}
+
+void CommandScript::updateCard(const pa_card_info &info) {
+    store(Card, info.index, info.name, info.proplist, nullptr, false);
+}
+
+void CommandScript::updateSink(const pa_sink_info &info) {
+    store(Sink, info.index, info.name, info.proplist, &info.volume, info.mute);
+}
+
+void CommandScript::updateSource(const pa_source_info &info) {
+    store(Source, info.index, info.name, info.proplist, &info.volume, info.mute);
+}
+
+void CommandScript::updateSinkInput(const pa_sink_input_info &info) {
+    store(SinkInput, info.index, nullptr, info.proplist, &info.volume, info.mute);
+}
+
+void CommandScript::updateSourceOutput(const pa_source_output_info &info) {
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+    store(SourceOutput, info.index, nullptr, info.proplist, &info.volume, info.mute);
+#else
+    store(SourceOutput, info.index, nullptr, info.proplist, nullptr, false);
+#endif
+}
+
+void CommandScript::remove(int facility, uint32_t index) {
+    switch (facility) {
+        case PA_SUBSCRIPTION_EVENT_SINK:
+            mObjects[Sink].remove(index);
+            break;
+        case PA_SUBSCRIPTION_EVENT_SOURCE:
+            mObjects[Source].remove(index);
+            break;
+        case PA_SUBSCRIPTION_EVENT_SINK_INPUT:
+            mObjects[SinkInput].remove(index);
+            break;
+        case PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT:
+            mObjects[SourceOutput].remove(index);
+            break;
+        case PA_SUBSCRIPTION_EVENT_CARD:
+            mObjects[Card].remove(index);
+            break;
+        default:
+            break;
+    }
+}
+
+QVector<const CommandScript::Object*> CommandScript::resolve(Kind kind, const QByteArray &target) const {
+    QVector<const Object*> found;
+    const QMap<uint32_t, Object> &objects = mObjects[kind];
+
+    bool isIndex;
+    const uint32_t index = target.toUInt(&isIndex);
+    if (isIndex) {
+        auto it = objects.constFind(index);
+        if (it != objects.constEnd())
+            found.append(&*it);
+        return found;
+    }
+
+    const int eq = target.indexOf('=');
+    if (eq > 0) {
+        const QByteArray key = target.left(eq);
+        const QRegExp pattern(str(target.mid(eq + 1)), Qt::CaseInsensitive, QRegExp::Wildcard);
+        for (const Object &o : objects) {
+            const char *value = pa_proplist_gets(o.proplist.data(), key.constData());
+            if (value && pattern.exactMatch(QString::fromUtf8(value)))
+                found.append(&o);
+        }
+        return found;
+    }
+
+    /* streams have no name of their own */
+    for (const Object &o : objects) {
+        const char *name = o.name.isNull() ? pa_proplist_gets(o.proplist.data(), PA_PROP_APPLICATION_NAME)
+                                           : o.name.constData();
+        if (name && target == name)
+            found.append(&o);
+    }
+    return found;
+}
+
+bool CommandScript::run(const Command &cmd, int n, QString *error) {
+    const QVector<const Object*> targets = resolve(cmd.kind, cmd.target);
+    if (targets.isEmpty()) {
+        *error = tr("no %1 matches \"%2\"").arg(QLatin1String(kindNames[cmd.kind]), str(cmd.target));
+        return false;
+    }
+    if (cmd.verb == Default && targets.size() > 1) {
+        *error = tr("\"%1\" matches %2 devices").arg(str(cmd.target)).arg(targets.size());
+        return false;
+    }
+
+    const Object *device = nullptr;
+    if (cmd.verb == Move) {
+        const Kind deviceKind = cmd.kind == SinkInput ? Sink : Source;
+        const QVector<const Object*> devices = resolve(deviceKind, cmd.argument);
+        if (devices.size() != 1) {
+            *error = devices.isEmpty()
+                ? tr("no %1 matches \"%2\"").arg(QLatin1String(kindNames[deviceKind]), str(cmd.argument))
+                : tr("\"%1\" matches %2 devices").arg(str(cmd.argument)).arg(devices.size());
+            return false;
+        }
+        device = devices.first();
+    }
+
+    pa_context *c = get_context();
+    OperationBatch *batch = new OperationBatch;
+
+    for (const Object *o : targets) {
+        const uint32_t idx = o->index;
+
+        switch (cmd.verb) {
+            case Volume: {
+                const pa_cvolume volume = adjustVolume(o->volume, cmd.relative, cmd.volume);
+
+                issue(batch, OperationStats::SetVolume, [&](pa_context_success_cb_t cb, void *ud) {
+                    switch (cmd.kind) {
+                        case Sink:
+                            return pa_context_set_sink_volume_by_index(c, idx, &volume, cb, ud);
+                        case Source:
+                            return pa_context_set_source_volume_by_index(c, idx, &volume, cb, ud);
+                        case SinkInput:
+                            return pa_context_set_sink_input_volume(c, idx, &volume, cb, ud);
+                        default:
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+                            return pa_context_set_source_output_volume(c, idx, &volume, cb, ud);
+#else
+                            /* refused by parse() */
+                            return static_cast<pa_operation *>(nullptr);
+#endif
+                    }
+                });
+                break;
+            }
+
+            case Mute: {
+                const int mute = cmd.mute < 0 ? !o->mute : cmd.mute;
+                issue(batch, OperationStats::SetMute, [&](pa_context_success_cb_t cb, void *ud) {
+                    switch (cmd.kind) {
+                        case Sink:
+                            return pa_context_set_sink_mute_by_index(c, idx, mute, cb, ud);
+                        case Source:
+                            return pa_context_set_source_mute_by_index(c, idx, mute, cb, ud);
+                        case SinkInput:
+                            return pa_context_set_sink_input_mute(c, idx, mute, cb, ud);
+                        default:
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+                            return pa_context_set_source_output_mute(c, idx, mute, cb, ud);
+#else
+                            /* refused by parse() */
+                            return static_cast<pa_operation *>(nullptr);
+#endif
+                    }
+                });
+                break;
+            }
+
+            case Move:
+                issue(batch, OperationStats::MoveStream, [&](pa_context_success_cb_t cb, void *ud) {
+                    return cmd.kind == SinkInput
+                        ? pa_context_move_sink_input_by_index(c, idx, device->index, cb, ud)
+                        : pa_context_move_source_output_by_index(c, idx, device->index, cb, ud);
+                });
+                break;
+
+            case Default:
+                issue(batch, OperationStats::SetDefault, [&](pa_context_success_cb_t cb, void *ud) {
+                    return cmd.kind == Sink
+                        ? pa_context_set_default_sink(c, o->name.constData(), cb, ud)
+                        : pa_context_set_default_source(c, o->name.constData(), cb, ud);
+                });
+                break;
+
+            case Profile:
+                issue(batch, OperationStats::SetProfile, [&](pa_context_success_cb_t cb, void *ud) {
+                    return pa_context_set_card_profile_by_index(c, idx, cmd.argument.constData(), cb, ud);
+                });
+                break;
+
+            case Port:
+                issue(batch, OperationStats::SetPort, [&](pa_context_success_cb_t cb, void *ud) {
+                    return cmd.kind == Sink
+                        ? pa_context_set_sink_port_by_index(c, idx, cmd.argument.constData(), cb, ud)
+                        : pa_context_set_source_port_by_index(c, idx, cmd.argument.constData(), cb, ud);
+                });
+                break;
+        }
+    }
+
+    QObject::connect(batch, &OperationBatch::finished, [this, n](int succeeded, int failed, int lost, qint64) {
+        if (failed == 0 && lost == 0)
+            commandDone(n, QStringLiteral("ok"), true);
+        else if (lost > 0)
+            commandDone(n, QStringLiteral("failed\t") + tr("%1 of %2 operations timed out").arg(lost).arg(succeeded + failed + lost), false);
+        else
+            commandDone(n, QStringLiteral("failed\t") + tr("%1 of %2 operations failed").arg(failed).arg(succeeded + failed + lost), false);
+    });
+    batch->commit();
+    return true;
+}
+
+void CommandScript::enumerationDone() {
+    /* only the initial enumeration runs the script */
+    if (mStarted)
+        return;
+    mStarted = true;
+
+    mStatus.resize(mCommands.size());
+
+    /* the count covers the whole script until every operation has been issued */
+    ++mPending;
+    for (int n = 0; n < mCommands.size(); n++) {
+        QString error;
+        ++mPending;
+        if (!run(mCommands[n], n, &error))
+            commandDone(n, QStringLiteral("error\t") + error, false);
+    }
+    commandDone(-1, QString(), true);
+}
+
+void CommandScript::commandDone(int n, const QString &status, bool ok) {
+    if (n >= 0)
+        mStatus[n] = status;
+    if (!ok)
+        mFailed = true;
+    if (--mPending > 0)
+        return;
+
+    /* one line per command: the script line, "ok", "failed" or "error", and the reason */
+    for (int i = 0; i < mCommands.size(); i++) {
+        const QByteArray line = QByteArray::number(mCommands[i].line) + '\t' + mStatus[i].toUtf8() + '\n';
+        fwrite(line.constData(), 1, line.size(), stdout);
+    }
+    fflush(stdout);
+
+    qApp->exit(mFailed ? 1 : 0);
+}
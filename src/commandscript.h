@@ -0,0 +1,129 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef commandscript_h
+#define commandscript_h
+
+#include "headlessclient.h"
+#include <QByteArray>
+#include <QMap>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+// --apply: runs a script of changes against the audio graph. One command per
+// line, '#' starts a comment and arguments containing blanks are quoted:
+//
+//     volume  sink|source|sink-input|source-output TARGET VOLUME
+//     mute    sink|source|sink-input|source-output TARGET on|off|toggle
+//     move    sink-input|source-output TARGET DEVICE
+//     default sink|source TARGET
+//     profile card TARGET PROFILE
+//     port    sink|source TARGET PORT
+//
+// A TARGET is an index, a name (the application.name of streams) or a
+// property=wildcard match, which may select several objects. VOLUME is a
+// percentage, a dB value or a raw volume; "+5%" and "-5%" are relative.
+//
+// The script is resolved against the initial enumeration, and all of its
+// operations are then issued back to back; once each has completed the
+// status of every command is written to the standard output, and the
+// process exits with a non-zero status if any of them failed.
+class CommandScript : public HeadlessClient {
+public:
+    // reads and parses the script; "-" is the standard input
+    static CommandScript *load(const QString &fileName, QString *error);
+
+    /* The syntax shared with the control socket, see ControlServer */
+    // splits a line at blanks, honouring double quotes; false on an unterminated quote
+    static bool tokenize(const QByteArray &line, QList<QByteArray> *args);
+    static bool parseVolume(const QByteArray &s, bool *relative, qint64 *volume);
+    // mute is 0, 1, or -1 to toggle
+    static bool parseMute(const QByteArray &s, int *mute);
+    static pa_cvolume adjustVolume(const pa_cvolume &current, bool relative, qint64 volume);
+
+    void updateCard(const pa_card_info &info) override;
+    void updateSink(const pa_sink_info &info) override;
+    void updateSource(const pa_source_info &info) override;
+    void updateSinkInput(const pa_sink_input_info &info) override;
+    void updateSourceOutput(const pa_source_output_info &info) override;
+
+    void remove(int facility, uint32_t index) override;
+    void enumerationDone() override;
+
+private:
+    enum Kind {
+        Sink,
+        Source,
+        SinkInput,
+        SourceOutput,
+        Card,
+        KindCount
+    };
+
+    enum Verb {
+        Volume,
+        Mute,
+        Move,
+        Default,
+        Profile,
+        Port
+    };
+
+    struct Command {
+        int line;
+        Verb verb;
+        Kind kind;
+        QByteArray target;
+        // the device, profile or port argument
+        QByteArray argument;
+        // volume: an absolute volume, or a signed step when relative
+        bool relative;
+        qint64 volume;
+        // mute: 0, 1, or -1 to toggle
+        int mute;
+    };
+
+    struct Object {
+        uint32_t index;
+        QByteArray name;
+        QSharedPointer<pa_proplist> proplist;
+        pa_cvolume volume;
+        bool mute;
+    };
+
+    CommandScript() : mPending(0), mFailed(false), mStarted(false) {}
+
+    bool parse(const QByteArray &script, QString *error);
+    bool parseLine(int line, const QList<QByteArray> &args, QString *error);
+
+    void store(Kind kind, uint32_t index, const char *name, pa_proplist *proplist,
+               const pa_cvolume *volume, bool mute);
+    QVector<const Object*> resolve(Kind kind, const QByteArray &target) const;
+    // issues the operations of a command; false with a reason if there are none
+    bool run(const Command &cmd, int n, QString *error);
+    void commandDone(int n, const QString &status, bool ok);
+
+    QVector<Command> mCommands;
+    QVector<QString> mStatus;
+    QMap<uint32_t, Object> mObjects[KindCount];
+    int mPending;
+    bool mFailed;
+    bool mStarted;
+};
+
+#endif
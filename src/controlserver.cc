@@ -0,0 +1,358 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "controlserver.h"
+#include "commandscript.h"
+#include "mainwindow.h"
+#include "sinkwidget.h"
+#include "sourcewidget.h"
+#include "sinkinputwidget.h"
+#include "sourceoutputwidget.h"
+#include <QFile>
+#include <QLocalSocket>
+#include <QRegExp>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QVector>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* a client that sends more than this without a newline is dropped */
+#define MAX_LINE_LENGTH 4096
+/* how long a second instance waits for the first one to answer, in ms */
+#define ACTIVATION_TIMEOUT 1000
+
+namespace {
+
+struct Target {
+    uint32_t index;
+    MinimalStreamWidget *widget;
+    QToolButton *muteButton;
+    // set for devices
+    DeviceWidget *device;
+    // set for streams
+    StreamWidget *stream;
+};
+
+} // namespace
+
+template <typename Widget>
+static void findDevices(const std::map<uint32_t, Widget*> &widgets, const QByteArray &target, QVector<Target> *found) {
+    bool isIndex;
+    const uint32_t index = target.toUInt(&isIndex);
+
+    for (const auto &it : widgets) {
+        Widget *w = it.second;
+        if (isIndex ? it.first == index : w->name == target)
+            found->append(Target{it.first, w, w->muteToggleButton, w, nullptr});
+    }
+}
+
+/* streams by index, or by a wildcard on the application part of their key */
+template <typename Widget>
+static void findStreams(const std::map<uint32_t, Widget*> &widgets, const QByteArray &target, QVector<Target> *found) {
+    bool isIndex;
+    const uint32_t index = target.toUInt(&isIndex);
+    const QRegExp pattern(QString::fromUtf8(target), Qt::CaseInsensitive, QRegExp::Wildcard);
+
+    for (const auto &it : widgets) {
+        Widget *w = it.second;
+        const int bar = w->streamKey.indexOf('|');
+        if (isIndex ? it.first == index : pattern.exactMatch(QString::fromUtf8(bar < 0 ? w->streamKey : w->streamKey.left(bar))))
+            found->append(Target{it.first, w, w->muteToggleButton, nullptr, w});
+    }
+}
+
+static bool resolve(const MainWindow *w, const QByteArray &kind, const QByteArray &target, QVector<Target> *found) {
+    if (kind == "sink")
+        findDevices(w->sinkWidgets, target, found);
+    else if (kind == "source")
+        findDevices(w->sourceWidgets, target, found);
+    else if (kind == "sink-input")
+        findStreams(w->sinkInputWidgets, target, found);
+    else if (kind == "source-output")
+        findStreams(w->sourceOutputWidgets, target, found);
+    else
+        return false;
+    return true;
+}
+
+static inline QByteArray errorReply(const QString &reason) {
+    return "error\t" + reason.toUtf8();
+}
+
+ControlServer::ControlServer(MainWindow *window, QObject *parent) :
+    QObject(parent),
+    mWindow(window) {
+
+    mServer.setSocketOptions(QLocalServer::UserAccessOption);
+    connect(&mServer, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+}
+
+ControlServer::~ControlServer() {
+    mServer.close();
+}
+
+QString ControlServer::socketPath() {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    return dir.isEmpty() ? QString() : dir + QStringLiteral("/pavucontrol-qt.socket");
+}
+
+bool ControlServer::listen() {
+    const QSettings config;
+    if (!config.value(QStringLiteral("control/socket"), true).toBool())
+        return false;
+
+    const QString path = socketPath();
+    if (path.isEmpty())
+        return false;
+    if (mServer.listen(path))
+        return true;
+
+    if (mServer.serverError() == QAbstractSocket::AddressInUseError) {
+        /* left behind by an instance that crashed, unless another one answers */
+        QLocalSocket probe;
+        probe.connectToServer(path);
+        if (probe.waitForConnected(100))
+            return false;
+
+        QLocalServer::removeServer(path);
+        if (mServer.listen(path))
+            return true;
+    }
+
+    qWarning("%s", tr("Cannot listen on %1: %2").arg(path, mServer.errorString()).toUtf8().constData());
+    return false;
+}
+
+bool ControlServer::activateRunningInstance(int argc, char **argv) {
+    QByteArray commands;
+    int count = 0;
+    bool maximize = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (!strcmp(arg, "--new-instance") || !strcmp(arg, "-h") || !strcmp(arg, "--help") || !strcmp(arg, "--help-all")
+                || !strcmp(arg, "-v") || !strcmp(arg, "--version"))
+            return false;
+        /* a recording needs a connection of its own */
+        if (!strcmp(arg, "--record-trace") || !strncmp(arg, "--record-trace=", 15))
+            return false;
+
+        if (!strcmp(arg, "--maximize") || !strcmp(arg, "-m"))
+            maximize = true;
+
+        const char *tab = nullptr;
+        if ((!strcmp(arg, "--tab") || !strcmp(arg, "-t")) && i + 1 < argc)
+            tab = argv[++i];
+        else if (!strncmp(arg, "--tab=", 6))
+            tab = arg + 6;
+        else if (!strncmp(arg, "-t", 2) && arg[2])
+            tab = arg + 2;
+
+        /* tabs out of range mean "any", which the running window already shows */
+        if (tab && atoi(tab) >= 1) {
+            commands += "tab ";
+            commands += QByteArray::number(atoi(tab));
+            commands += '\n';
+            count++;
+        }
+    }
+    if (maximize) {
+        commands += "maximize\n";
+        count++;
+    }
+    commands += "raise\n";
+    count++;
+
+    const QByteArray path = QFile::encodeName(socketPath());
+    sockaddr_un addr;
+    if (path.isEmpty() || path.size() >= (int) sizeof(addr.sun_path))
+        return false;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.constData(), path.size());
+
+    /* plain sockets: there is no event loop yet */
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    if (::connect(fd, (const sockaddr*) &addr, sizeof(addr)) < 0
+            || write(fd, commands.constData(), commands.size()) != (ssize_t) commands.size()) {
+        close(fd);
+        return false;
+    }
+
+    QByteArray replies;
+    char buf[256];
+    pollfd pfd = { fd, POLLIN, 0 };
+    while (replies.count('\n') < count && poll(&pfd, 1, ACTIVATION_TIMEOUT) > 0) {
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0)
+            break;
+        replies.append(buf, n);
+    }
+    close(fd);
+
+    /* an instance that does not answer is not one we can hand over to */
+    if (replies.count('\n') < count)
+        return false;
+
+    for (const QByteArray &reply : replies.split('\n')) {
+        if (reply.startsWith("error"))
+            fprintf(stderr, "%s\n", reply.mid(6).constData());
+    }
+    return true;
+}
+
+void ControlServer::onNewConnection() {
+    while (QLocalSocket *socket = mServer.nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, &ControlServer::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void ControlServer::onReadyRead() {
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket)
+        return;
+
+    /* all the commands that came in together are answered in one write */
+    QByteArray replies;
+    while (socket->canReadLine()) {
+        QList<QByteArray> args;
+        if (!CommandScript::tokenize(socket->readLine(), &args))
+            replies += errorReply(tr("unterminated quote"));
+        else if (args.isEmpty())
+            continue;
+        else
+            replies += execute(args);
+        replies += '\n';
+    }
+
+    if (!replies.isEmpty())
+        socket->write(replies);
+
+    if (socket->bytesAvailable() > MAX_LINE_LENGTH)
+        socket->abort();
+}
+
+QByteArray ControlServer::execute(const QList<QByteArray> &args) {
+    const QByteArray &verb = args[0];
+
+    if (verb == "tab") {
+        bool ok = false;
+        const int tab = args.size() == 2 ? args[1].toInt(&ok) : 0;
+        if (!ok || tab < 1 || tab > mWindow->notebook->count())
+            return errorReply(tr("invalid tab"));
+        mWindow->selectTab(tab);
+        return "ok";
+    }
+
+    if (verb == "maximize") {
+        mWindow->setWindowState(mWindow->windowState() | Qt::WindowMaximized);
+        return "ok";
+    }
+
+    if (verb == "raise") {
+        mWindow->setWindowState((mWindow->windowState() & ~Qt::WindowMinimized) | Qt::WindowActive);
+        mWindow->show();
+        mWindow->raise();
+        mWindow->activateWindow();
+        return "ok";
+    }
+
+    if (verb == "snapshot") {
+        if (args.size() != 2)
+            return errorReply(tr("%1 takes %2 arguments").arg(QString::fromUtf8(verb)).arg(1));
+
+        QFile file(QString::fromLocal8Bit(args[1]));
+        if (!file.open(QIODevice::ReadOnly))
+            return errorReply(file.errorString());
+
+        QString error;
+        if (!mWindow->applySnapshot(file.readAll(), &error))
+            return errorReply(error);
+        return "ok";
+    }
+
+    if (verb != "volume" && verb != "mute" && verb != "move" && verb != "default")
+        return errorReply(tr("unknown command \"%1\"").arg(QString::fromUtf8(verb)));
+
+    const int nargs = verb == "default" ? 3 : 4;
+    if (args.size() != nargs)
+        return errorReply(tr("%1 takes %2 arguments").arg(QString::fromUtf8(verb)).arg(nargs - 1));
+
+    QVector<Target> targets;
+    if (!resolve(mWindow, args[1], args[2], &targets))
+        return errorReply(tr("%1 does not apply to \"%2\"").arg(QString::fromUtf8(verb), QString::fromUtf8(args[1])));
+    if (targets.isEmpty())
+        return errorReply(tr("no %1 matches \"%2\"").arg(QString::fromUtf8(args[1]), QString::fromUtf8(args[2])));
+
+    if (verb == "volume") {
+        bool relative;
+        qint64 volume;
+        if (!CommandScript::parseVolume(args[3], &relative, &volume))
+            return errorReply(tr("invalid volume \"%1\"").arg(QString::fromUtf8(args[3])));
+
+        for (const Target &t : targets)
+            t.widget->applyVolume(CommandScript::adjustVolume(t.widget->currentVolume(), relative, volume));
+
+    } else if (verb == "mute") {
+        int mute;
+        if (!CommandScript::parseMute(args[3], &mute))
+            return errorReply(tr("invalid mute state \"%1\"").arg(QString::fromUtf8(args[3])));
+
+        /* the button sends the change, as a click would */
+        for (const Target &t : targets)
+            t.muteButton->setChecked(mute < 0 ? !t.muteButton->isChecked() : mute != 0);
+
+    } else if (verb == "move") {
+        if (!targets.first().stream)
+            return errorReply(tr("%1 does not apply to \"%2\"").arg(QString::fromUtf8(verb), QString::fromUtf8(args[1])));
+
+        const QByteArray deviceKind = args[1] == "sink-input" ? "sink" : "source";
+        QVector<Target> devices;
+        resolve(mWindow, deviceKind, args[3], &devices);
+        if (devices.size() != 1)
+            return errorReply(devices.isEmpty()
+                ? tr("no %1 matches \"%2\"").arg(QString::fromUtf8(deviceKind), QString::fromUtf8(args[3]))
+                : tr("\"%1\" matches %2 devices").arg(QString::fromUtf8(args[3])).arg(devices.size()));
+
+        for (const Target &t : targets)
+            t.stream->moveToDevice(devices.first().index);
+
+    } else {
+        if (!targets.first().device)
+            return errorReply(tr("%1 does not apply to \"%2\"").arg(QString::fromUtf8(verb), QString::fromUtf8(args[1])));
+        if (targets.size() > 1)
+            return errorReply(tr("\"%1\" matches %2 devices").arg(QString::fromUtf8(args[2])).arg(targets.size()));
+
+        targets.first().device->defaultToggleButton->setChecked(true);
+    }
+
+    return "ok";
+}
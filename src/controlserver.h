@@ -0,0 +1,76 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef controlserver_h
+#define controlserver_h
+
+#include <QByteArray>
+#include <QList>
+#include <QLocalServer>
+#include <QObject>
+
+class MainWindow;
+class QLocalSocket;
+
+// A local socket through which other programs drive the running window,
+// using its connection and the state it already has. Clients write commands
+// one per line, any number at a time, in the --apply syntax (see
+// CommandScript) with the addition of
+//
+//     tab N
+//     snapshot FILE
+//     maximize
+//     raise
+//
+// Devices are addressed by index or name, streams by index or by a wildcard
+// on their application. Every command is answered by a line, in order:
+// "ok", or "error" and a tab followed by the reason. Commands are carried
+// out as if made in the window: they show up there right away and can be
+// undone.
+//
+// The socket is only accessible to the user; it can be turned off with the
+// control/socket setting.
+class ControlServer : public QObject {
+    Q_OBJECT
+public:
+    explicit ControlServer(MainWindow *window, QObject *parent = nullptr);
+    ~ControlServer() override;
+
+    bool listen();
+
+    // the path of the socket, in the user's runtime directory
+    static QString socketPath();
+
+    // Hands the --tab and --maximize arguments to an instance that is already
+    // running and raises its window; false if there is none, or if argv asks
+    // for a new one. This runs before the application object is created, so
+    // that a second invocation costs next to nothing.
+    static bool activateRunningInstance(int argc, char **argv);
+
+    // runs a tokenized command, returns the reply without its newline
+    QByteArray execute(const QList<QByteArray> &args);
+
+private Q_SLOTS:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    MainWindow *mWindow;
+    QLocalServer mServer;
+};
+
+#endif
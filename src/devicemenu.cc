@@ -0,0 +1,104 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "devicemenu.h"
+#include "streamwidget.h"
+#include <QCursor>
+
+DeviceMenu::DeviceMenu(QWidget *parent) :
+    QMenu(parent),
+    mChecked(nullptr) {
+
+    connect(this, &QMenu::triggered, this, &DeviceMenu::onTriggered);
+}
+
+void DeviceMenu::setDevice(uint32_t index, const QByteArray &description) {
+    auto it = mActions.find(index);
+
+    if (it != mActions.end()) {
+        if (it->second->data().toByteArray() != description) {
+            it->second->setData(description);
+            it->second->setText(QString::fromUtf8(description));
+        }
+        return;
+    }
+
+    QAction *action = new QAction(QString::fromUtf8(description), this);
+    action->setData(description);
+    action->setCheckable(true);
+
+    /* Keep the entries ordered by device index */
+    it = mActions.emplace(index, action).first;
+    ++it;
+    insertAction(it != mActions.end() ? it->second : nullptr, action);
+}
+
+void DeviceMenu::removeDevice(uint32_t index) {
+    auto it = mActions.find(index);
+
+    if (it == mActions.end())
+        return;
+
+    if (it->second == mChecked)
+        mChecked = nullptr;
+    delete it->second;
+    mActions.erase(it);
+}
+
+void DeviceMenu::clearDevices() {
+    for (auto &action : mActions)
+        delete action.second;
+    mActions.clear();
+    mChecked = nullptr;
+}
+
+void DeviceMenu::popupFor(StreamWidget *stream, uint32_t current) {
+    auto it = mActions.find(current);
+    QAction *checked = it != mActions.end() ? it->second : nullptr;
+
+    if (mChecked && mChecked != checked)
+        mChecked->setChecked(false);
+    if (checked)
+        checked->setChecked(true);
+    mChecked = checked;
+
+    mStream = stream;
+    popup(QCursor::pos());
+}
+
+void DeviceMenu::onTriggered(QAction *action) {
+    /* Triggering toggled the entry; keep exactly the chosen one checked */
+    if (mChecked && mChecked != action)
+        mChecked->setChecked(false);
+    action->setChecked(true);
+    mChecked = action;
+
+    /* The stream may have gone away while the menu was open */
+    if (!mStream)
+        return;
+
+    for (const auto &a : mActions) {
+        if (a.second == action) {
+            mStream->moveToDevice(a.first);
+            break;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef devicemenu_h
+#define devicemenu_h
+
+#include <QByteArray>
+#include <QMenu>
+#include <QPointer>
+#include <map>
+
+class StreamWidget;
+
+// The menu listing the sinks (or sources) a stream can be moved to. There is
+// one per direction, shared by all stream widgets and kept up to date by the
+// main window as devices come, go and get renamed, so that popping it up
+// neither rebuilds nor allocates anything.
+class DeviceMenu : public QMenu {
+    Q_OBJECT
+public:
+    explicit DeviceMenu(QWidget *parent = nullptr);
+
+    // adds the device, or relabels it if it is known already
+    void setDevice(uint32_t index, const QByteArray &description);
+    void removeDevice(uint32_t index);
+    void clearDevices();
+
+    // shows the menu with current checked; the choice is passed to stream->moveToDevice()
+    void popupFor(StreamWidget *stream, uint32_t current);
+
+private:
+    void onTriggered(QAction *action);
+
+    std::map<uint32_t, QAction*> mActions;
+    QAction *mChecked;
+    QPointer<StreamWidget> mStream;
+};
+
+#endif
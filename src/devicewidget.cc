@@ -27,6 +27,8 @@
 #include "mainwindow.h"
 #include "devicewidget.h"
 #include "channel.h"
+#include "choicelistmodel.h"
+#include "operationstats.h"
 #include <sstream>
 #include <QAction>
 #include <QLabel>
@@ -34,21 +36,30 @@
 #include <QInputDialog>
 #include <utility>
 
+/* "Duck" lowers the volume by this much, in this many ms */
+#define DUCK_DB -12
+#define DUCK_DURATION 500
+
 /*** DeviceWidget ***/
 DeviceWidget::DeviceWidget(MainWindow* parent, QByteArray deviceType) :
     MinimalStreamWidget(parent),
     offsetButtonEnabled(false),
     mpMainWindow(parent),
+    channelsCanDecibel(false),
+    channelsRow(-1),
+    baseVolume(PA_VOLUME_NORM),
     rename{new QAction{tr("Rename device..."), this}},
+    duck{new QAction{tr("Duck by %1 dB").arg(-DUCK_DB), this}},
     mDeviceType(std::move(deviceType)) {
 
     setupUi(this);
     advancedWidget->hide();
     initPeakProgressBar(channelsGrid);
 
-    timeout.setSingleShot(true);
-    timeout.setInterval(100);
-    connect(&timeout, &QTimer::timeout, this, &DeviceWidget::timeoutEvent);
+    card_index = PA_INVALID_INDEX;
+
+    portModel = new ChoiceListModel(this);
+    portList->setModel(portModel);
 
     connect(muteToggleButton, &QToolButton::toggled, this, &DeviceWidget::onMuteToggleButton);
     connect(lockToggleButton, &QToolButton::toggled, this, &DeviceWidget::onLockToggleButton);
@@ -56,6 +67,9 @@ DeviceWidget::DeviceWidget(MainWindow* parent, QByteArray deviceType) :
 
     connect(rename, &QAction::triggered, this, &DeviceWidget::renamePopup);
     addAction(rename);
+    duck->setCheckable(true);
+    connect(duck, &QAction::toggled, this, &DeviceWidget::onDuckToggled);
+    addAction(duck);
     setContextMenuPolicy(Qt::ActionsContextMenu);
 
     connect(portList, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &DeviceWidget::onPortChange);
@@ -63,7 +77,9 @@ DeviceWidget::DeviceWidget(MainWindow* parent, QByteArray deviceType) :
 
     for (auto & channel : channels)
         channel = nullptr;
-
+    channelMap.channels = 0;
+    pa_cvolume_init(&volume);
+    pa_cvolume_init(&unduckedVolume);
 
     // FIXME:
 //    offsetAdjustment = Gtk::Adjustment::create(0.0, -2000.0, 2000.0, 10.0, 50.0, 0.0);
@@ -72,20 +88,33 @@ DeviceWidget::DeviceWidget(MainWindow* parent, QByteArray deviceType) :
 
 void DeviceWidget::setChannelMap(const pa_channel_map &m, bool can_decibel) {
     channelMap = m;
+    channelsCanDecibel = can_decibel;
+    /* reserve one grid row per channel, in channel order */
+    channelsRow = channelsGrid->rowCount();
+
+    lockToggleButton->setEnabled(m.channels > 1);
+    hideLockedChannels(lockToggleButton->isChecked());
+}
+
+Channel *DeviceWidget::channel(int i) {
+    g_assert(i < channelMap.channels);
 
-    for (int i = 0; i < m.channels; i++) {
-        Channel *ch = channels[i] = new Channel(channelsGrid);
+    if (!channels[i]) {
+        Channel *ch = channels[i] = new Channel(channelsGrid, channelsRow + i);
         ch->channel = i;
-        ch->can_decibel = can_decibel;
+        ch->can_decibel = channelsCanDecibel;
         ch->minimalStreamWidget = this;
+        ch->last = i == channelMap.channels - 1;
         char text[64];
-        snprintf(text, sizeof(text), "<b>%s</b>", pa_channel_position_to_pretty_string(m.map[i]));
+        snprintf(text, sizeof(text), "<b>%s</b>", pa_channel_position_to_pretty_string(channelMap.map[i]));
         ch->channelLabel->setText(QString::fromUtf8(text));
+        ch->setBaseVolume(baseVolume);
+        if (volume.channels == channelMap.channels)
+            ch->setVolume(volume.values[i]);
+        ch->setEnabled(!muteToggleButton->isChecked());
     }
-    channels[m.channels-1]->last = true;
 
-    lockToggleButton->setEnabled(m.channels > 1);
-    hideLockedChannels(lockToggleButton->isChecked());
+    return channels[i];
 }
 
 void DeviceWidget::setVolume(const pa_cvolume &v, bool force) {
@@ -93,9 +122,11 @@ void DeviceWidget::setVolume(const pa_cvolume &v, bool force) {
 
     volume = v;
 
-    if (!timeout.isActive() || force) { /* do not update the volume when a volume change is still in flux */
-        for (int i = 0; i < volume.channels; i++)
-            channels[i]->setVolume(volume.values[i]);
+    if (!volumeUpdateInFlight() || force) { /* do not update the volume when a volume change is still in flux */
+        for (int i = 0; i < volume.channels; i++) {
+            if (channels[i])
+                channels[i]->setVolume(volume.values[i]);
+        }
     }
 }
 
@@ -109,26 +140,43 @@ void DeviceWidget::updateChannelVolume(int channel, pa_volume_t v) {
     else
         n.values[channel] = v;
 
-    setVolume(n, true);
+    applyVolume(n);
+}
 
-    if (!timeout.isActive()) {
-        timeout.start();
-    }
+void DeviceWidget::applyVolume(const pa_cvolume &v) {
+    cancelFade();
+    recordVolume(volume, v);
+    setVolume(v, true);
+
+    requestVolumeUpdate();
 }
 
 void DeviceWidget::hideLockedChannels(bool hide) {
-    for (int i = 0; i < channelMap.channels - 1; i++)
-        channels[i]->setVisible(!hide);
+    for (int i = 0; i < channelMap.channels - 1; i++) {
+        if (!hide)
+            channel(i)->setVisible(true);
+        else if (channels[i])
+            channels[i]->setVisible(false);
+    }
 
-    channels[channelMap.channels - 1]->channelLabel->setVisible(!hide);
+    channel(channelMap.channels - 1)->channelLabel->setVisible(!hide);
+}
+
+void DeviceWidget::setVolumeTracking(bool tracking) {
+    for (int i = 0; i < channelMap.channels; i++) {
+        if (channels[i])
+            channels[i]->setTracking(tracking);
+    }
 }
 
 void DeviceWidget::onMuteToggleButton() {
 
     lockToggleButton->setEnabled(!muteToggleButton->isChecked());
 
-    for (int i = 0; i < channelMap.channels; i++)
-        channels[i]->setEnabled(!muteToggleButton->isChecked());
+    for (int i = 0; i < channelMap.channels; i++) {
+        if (channels[i])
+            channels[i]->setEnabled(!muteToggleButton->isChecked());
+    }
 }
 
 void DeviceWidget::onLockToggleButton() {
@@ -151,11 +199,13 @@ void DeviceWidget::onOffsetChange() {
     card_stream << card_index;
     card_name = QByteArray::fromStdString(card_stream.str());
 
+    OperationStats::Tracker t(OperationStats::SetLatencyOffset);
     if (!(o = pa_context_set_port_latency_offset(get_context(),
-            card_name.constData(), activePort.constData(), offset, nullptr, nullptr))) {
+            card_name.constData(), activePort.constData(), offset, t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_port_latency_offset() failed").toUtf8().constData());
         return;
     }
+    t.attach(o);
     pa_operation_unref(o);
 }
 
@@ -164,14 +214,6 @@ void DeviceWidget::setDefault(bool isDefault) {
     /*defaultToggleButton->setEnabled(!isDefault);*/
 }
 
-bool DeviceWidget::timeoutEvent() {
-    executeVolumeUpdate();
-    return false;
-}
-
-void DeviceWidget::executeVolumeUpdate() {
-}
-
 void DeviceWidget::setLatencyOffset(int64_t offset) {
     offsetButtonEnabled = false;
     offsetButton->setValue(offset / 1000.0);
@@ -179,27 +221,20 @@ void DeviceWidget::setLatencyOffset(int64_t offset) {
 }
 
 void DeviceWidget::setBaseVolume(pa_volume_t v) {
+    baseVolume = v;
 
-    for (int i = 0; i < channelMap.channels; i++)
-        channels[i]->setBaseVolume(v);
+    for (int i = 0; i < channelMap.channels; i++) {
+        if (channels[i])
+            channels[i]->setBaseVolume(v);
+    }
 }
 
 void DeviceWidget::prepareMenu() {
-    int idx = 0;
-    int active_idx = -1;
-
-    portList->clear();
-    /* Fill the ComboBox's Model */
-    for (auto & port : ports) {
-        QByteArray name = port.first;
-        QString desc = QString::fromUtf8(port.second);
-        portList->addItem(desc, name);
-        if (port.first == activePort)
-            active_idx = idx;
-        idx++;
-    }
+    /* Update the ComboBox's Model */
+    portModel->setChoices(ports);
 
-    if (active_idx >= 0)
+    const int active_idx = portModel->row(activePort);
+    if (active_idx >= 0 && active_idx != portList->currentIndex())
         portList->setCurrentIndex(active_idx);
 
     if (!ports.empty()) {
@@ -237,10 +272,24 @@ void DeviceWidget::renamePopup() {
         pa_operation* o;
         gchar *key = g_markup_printf_escaped("%s:%s", mDeviceType.constData(), name.constData());
 
-        if (!(o = pa_ext_device_manager_set_device_description(get_context(), key, new_name.toUtf8().constData(), nullptr, nullptr)))
+        OperationStats::Tracker t(OperationStats::RenameDevice);
+        if (!(o = pa_ext_device_manager_set_device_description(get_context(), key, new_name.toUtf8().constData(), t.callback(), t.userdata())))
             show_error(tr("pa_ext_device_manager_set_device_description() failed").toUtf8().constData());
-        else
+        else {
+            t.attach(o);
             pa_operation_unref(o);
+        }
         g_free(key);
     }
 }
+
+void DeviceWidget::onDuckToggled(bool ducked) {
+    if (ducked) {
+        pa_cvolume v;
+
+        unduckedVolume = volume;
+        pa_sw_cvolume_multiply_scalar(&v, &volume, pa_sw_volume_from_dB(DUCK_DB));
+        fadeVolume(v, DUCK_DURATION);
+    } else
+        fadeVolume(unduckedVolume, DUCK_DURATION);
+}
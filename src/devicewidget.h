@@ -25,9 +25,10 @@
 
 #include "minimalstreamwidget.h"
 #include "ui_devicewidget.h"
-#include <QTimer>
 #include <vector>
 
+class ChoiceListModel;
+
 class MainWindow;
 class Channel;
 class QAction;
@@ -42,6 +43,9 @@ public:
     virtual void updateChannelVolume(int channel, pa_volume_t v);
 
     void hideLockedChannels(bool hide = true);
+    void setVolumeTracking(bool tracking) override;
+    const pa_cvolume &currentVolume() const override { return volume; }
+    void applyVolume(const pa_cvolume &v) override;
 
     QByteArray name;
     QByteArray description;
@@ -52,7 +56,10 @@ public:
     pa_channel_map channelMap;
     pa_cvolume volume;
 
+    /* Channels are created on demand: while the channels are locked only
+     * the last one is shown, so that is the only one we build. */
     Channel *channels[PA_CHANNELS_MAX];
+    Channel *channel(int i);
 
 public Q_SLOTS:
     virtual void onMuteToggleButton();
@@ -62,12 +69,9 @@ public Q_SLOTS:
     // virtual bool onContextTriggerEvent(GdkEventButton*);
     virtual void setLatencyOffset(int64_t offset);
     void onOffsetChange();
-    bool timeoutEvent();
 
 public:
-    QTimer timeout;
 
-    virtual void executeVolumeUpdate();
     virtual void setBaseVolume(pa_volume_t v);
 
     std::vector< std::pair<QByteArray,QByteArray> > ports;
@@ -76,13 +80,23 @@ public:
     void prepareMenu();
 
     void renamePopup();
+    void onDuckToggled(bool ducked);
 
 protected:
     MainWindow *mpMainWindow;
 
+    bool channelsCanDecibel;
+    int channelsRow;
+    pa_volume_t baseVolume;
+
     virtual void onPortChange() = 0;
 
+    ChoiceListModel *portModel;
+
     QAction * rename;
+    QAction * duck;
+    // the volume to return to when ducking ends
+    pa_cvolume unduckedVolume;
 
 private:
     QByteArray mDeviceType;
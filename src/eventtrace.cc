@@ -0,0 +1,472 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "eventtrace.h"
+#include <pulse/timeval.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <string.h>
+
+/* how often the recording is flushed to disk, in ms */
+#define FLUSH_INTERVAL 1000
+
+/* as in pavucontrol.h, which the libpulse stand-in is built without */
+#ifndef HAVE_SOURCE_OUTPUT_VOLUMES
+#define HAVE_SOURCE_OUTPUT_VOLUMES PA_CHECK_VERSION(0,99,0)
+#endif
+
+static const char magic[8] = { 'P', 'V', 'C', 'T', 'R', 'A', 'C', 'E' };
+
+QFile *EventTrace::file = nullptr;
+static QElapsedTimer recordingClock;
+static qint64 lastFlush;
+
+namespace {
+
+/* the info payload: see EventTrace::Object for the fields, in this order */
+class Encoder {
+public:
+    Encoder() { mOut.reserve(512); }
+
+    void u8(uint8_t v) { mOut.append(static_cast<char>(v)); }
+    void u32(uint32_t v) { mOut.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+    void i32(int32_t v) { mOut.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+    void i64(int64_t v) { mOut.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+
+    void string(const char *s) {
+        const uint32_t n = s ? strlen(s) : 0;
+        u32(n);
+        mOut.append(s, n);
+    }
+
+    void proplist(const pa_proplist *p) {
+        const int at = mOut.size();
+        uint32_t n = 0;
+        u32(n);
+
+        void *state = nullptr;
+        while (const char *key = pa_proplist_iterate(p, &state)) {
+            /* binary values are of no use to us */
+            const char *value = pa_proplist_gets(p, key);
+            if (!value)
+                continue;
+            string(key);
+            string(value);
+            n++;
+        }
+        memcpy(mOut.data() + at, &n, sizeof(n));
+    }
+
+    void channelMap(const pa_channel_map *m) {
+        u8(m ? m->channels : 0);
+        for (int c = 0; m && c < m->channels; c++)
+            i32(m->map[c]);
+    }
+
+    void volume(const pa_cvolume *v) {
+        u8(v ? v->channels : 0);
+        for (int c = 0; v && c < v->channels; c++)
+            u32(v->values[c]);
+    }
+
+    // everything up to the ports
+    void common(const char *name, const char *description, const pa_proplist *p,
+                const pa_channel_map *map, const pa_cvolume *volume, int mute,
+                uint32_t flags, uint32_t baseVolume, uint32_t card, uint32_t peer, uint32_t client) {
+        string(name);
+        string(description);
+        if (p)
+            proplist(p);
+        else
+            u32(0);
+        channelMap(map);
+        this->volume(volume);
+        i32(mute);
+        u32(flags);
+        u32(baseVolume);
+        u32(card);
+        u32(peer);
+        u32(client);
+    }
+
+    void port(const char *name, const char *description, uint32_t priority, int available,
+              int direction, int64_t latencyOffset) {
+        string(name);
+        string(description);
+        u32(priority);
+        i32(available);
+        i32(direction);
+        i64(latencyOffset);
+    }
+
+    template <typename PortInfo>
+    void devicePorts(uint32_t n, PortInfo *const *ports, const PortInfo *active, int direction) {
+        u32(n);
+        for (uint32_t i = 0; i < n; i++) {
+            port(ports[i]->name, ports[i]->description, ports[i]->priority, ports[i]->available, direction, 0);
+            u32(0);
+        }
+        string(active ? active->name : nullptr);
+    }
+
+    void noPorts() {
+        u32(0);
+        string(nullptr);
+    }
+
+    void noProfiles() {
+        u32(0);
+        string(nullptr);
+    }
+
+    const QByteArray &data() const { return mOut; }
+
+private:
+    QByteArray mOut;
+};
+
+class Decoder {
+public:
+    Decoder(const char *data, size_t size) : mPos(data), mEnd(data + size), mOk(true) {}
+
+    bool ok() const { return mOk && mPos == mEnd; }
+
+    uint8_t u8() { uint8_t v = 0; take(&v, sizeof(v)); return v; }
+    uint32_t u32() { uint32_t v = 0; take(&v, sizeof(v)); return v; }
+    int32_t i32() { int32_t v = 0; take(&v, sizeof(v)); return v; }
+    int64_t i64() { int64_t v = 0; take(&v, sizeof(v)); return v; }
+
+    QByteArray string() {
+        const uint32_t n = u32();
+        if (!mOk || n > (size_t) (mEnd - mPos)) {
+            mOk = false;
+            return QByteArray();
+        }
+        const QByteArray s(mPos, n);
+        mPos += n;
+        return s;
+    }
+
+    // a count that cannot be more than what is left, against corrupt files
+    uint32_t count() {
+        const uint32_t n = u32();
+        if (n > (size_t) (mEnd - mPos))
+            mOk = false;
+        return mOk ? n : 0;
+    }
+
+    void channelMap(pa_channel_map *m) {
+        m->channels = u8();
+        if (m->channels > PA_CHANNELS_MAX) {
+            mOk = false;
+            m->channels = 0;
+        }
+        for (int c = 0; c < m->channels; c++)
+            m->map[c] = static_cast<pa_channel_position_t>(i32());
+    }
+
+    void volume(pa_cvolume *v) {
+        v->channels = u8();
+        if (v->channels > PA_CHANNELS_MAX) {
+            mOk = false;
+            v->channels = 0;
+        }
+        for (int c = 0; c < v->channels; c++)
+            v->values[c] = u32();
+    }
+
+private:
+    void take(void *v, size_t n) {
+        if (!mOk || n > (size_t) (mEnd - mPos)) {
+            mOk = false;
+            return;
+        }
+        memcpy(v, mPos, n);
+        mPos += n;
+    }
+
+    const char *mPos;
+    const char *mEnd;
+    bool mOk;
+};
+
+} // namespace
+
+bool EventTrace::start(const QString &path, QString *error) {
+    QFile *f = new QFile(path);
+    if (!f->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        *error = QCoreApplication::translate("EventTrace", "Cannot write %1: %2").arg(path, f->errorString());
+        delete f;
+        return false;
+    }
+
+    FileHeader h;
+    timeval tv;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, magic, sizeof(h.magic));
+    h.version = Version;
+    h.headerSize = sizeof(h);
+    h.startTime = pa_timeval_load(pa_gettimeofday(&tv));
+    f->write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    file = f;
+    recordingClock.start();
+    lastFlush = 0;
+    return true;
+}
+
+void EventTrace::stop() {
+    if (!file)
+        return;
+
+    file->close();
+    delete file;
+    file = nullptr;
+}
+
+void EventTrace::write(RecordType type, int facility, int event, uint32_t index, const QByteArray &payload) {
+    static const char padding[8] = {};
+    RecordHeader h;
+
+    memset(&h, 0, sizeof(h));
+    h.time = recordingClock.nsecsElapsed() / 1000;
+    h.type = type;
+    h.facility = facility;
+    h.event = event;
+    h.index = index;
+    h.size = payload.size();
+
+    file->write(reinterpret_cast<const char*>(&h), sizeof(h));
+    file->write(payload.constData(), payload.size());
+    file->write(padding, -payload.size() & 7);
+
+    const qint64 now = recordingClock.elapsed();
+    if (now - lastFlush < FLUSH_INTERVAL)
+        return;
+
+    lastFlush = now;
+    if (!file->flush()) {
+        qWarning("%s", QCoreApplication::translate("EventTrace", "Cannot write %1: %2; the recording stops here")
+                 .arg(file->fileName(), file->errorString()).toUtf8().constData());
+        stop();
+    }
+}
+
+void EventTrace::connected() {
+    write(ConnectedRecord, 0, 0, PA_INVALID_INDEX, QByteArray());
+}
+
+void EventTrace::event(pa_subscription_event_type_t t, uint32_t index) {
+    write(EventRecord, t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK, t & PA_SUBSCRIPTION_EVENT_TYPE_MASK, index, QByteArray());
+}
+
+void EventTrace::meterSample(uint32_t source, uint32_t stream, float value) {
+    const MeterSample s = { stream, value };
+    write(MeterRecord, PA_SUBSCRIPTION_EVENT_SOURCE, 0, source, QByteArray(reinterpret_cast<const char*>(&s), sizeof(s)));
+}
+
+void EventTrace::info(const pa_card_info &i) {
+    Encoder e;
+    e.common(i.name, nullptr, i.proplist, nullptr, nullptr, 0, 0, 0, PA_INVALID_INDEX, PA_INVALID_INDEX, PA_INVALID_INDEX);
+
+    e.u32(i.n_ports);
+    for (uint32_t p = 0; p < i.n_ports; p++) {
+        const pa_card_port_info *port = i.ports[p];
+        e.port(port->name, port->description, port->priority, port->available, port->direction, port->latency_offset);
+
+        uint32_t n = 0;
+        for (pa_card_profile_info2 **profile = port->profiles2; profile && *profile; ++profile)
+            n++;
+        e.u32(n);
+        for (pa_card_profile_info2 **profile = port->profiles2; profile && *profile; ++profile)
+            e.string((*profile)->name);
+    }
+    e.string(nullptr);
+
+    uint32_t n = 0;
+    for (pa_card_profile_info2 **profile = i.profiles2; profile && *profile; ++profile)
+        n++;
+    e.u32(n);
+    for (pa_card_profile_info2 **profile = i.profiles2; profile && *profile; ++profile) {
+        const pa_card_profile_info2 *p = *profile;
+        e.string(p->name);
+        e.string(p->description);
+        e.u32(p->n_sinks);
+        e.u32(p->n_sources);
+        e.u32(p->priority);
+        e.i32(p->available);
+    }
+    e.string(i.active_profile2 ? i.active_profile2->name : i.active_profile ? i.active_profile->name : nullptr);
+
+    write(InfoRecord, PA_SUBSCRIPTION_EVENT_CARD, 0, i.index, e.data());
+}
+
+void EventTrace::info(const pa_sink_info &i) {
+    Encoder e;
+    e.common(i.name, i.description, i.proplist, &i.channel_map, &i.volume, i.mute,
+             i.flags, i.base_volume, i.card, i.monitor_source, PA_INVALID_INDEX);
+    e.devicePorts(i.n_ports, i.ports, i.active_port, PA_DIRECTION_OUTPUT);
+    e.noProfiles();
+    write(InfoRecord, PA_SUBSCRIPTION_EVENT_SINK, 0, i.index, e.data());
+}
+
+void EventTrace::info(const pa_source_info &i) {
+    Encoder e;
+    e.common(i.name, i.description, i.proplist, &i.channel_map, &i.volume, i.mute,
+             i.flags, i.base_volume, i.card, i.monitor_of_sink, PA_INVALID_INDEX);
+    e.devicePorts(i.n_ports, i.ports, i.active_port, PA_DIRECTION_INPUT);
+    e.noProfiles();
+    write(InfoRecord, PA_SUBSCRIPTION_EVENT_SOURCE, 0, i.index, e.data());
+}
+
+void EventTrace::info(const pa_sink_input_info &i) {
+    Encoder e;
+    e.common(i.name, nullptr, i.proplist, &i.channel_map, &i.volume, i.mute,
+             0, 0, PA_INVALID_INDEX, i.sink, i.client);
+    e.noPorts();
+    e.noProfiles();
+    write(InfoRecord, PA_SUBSCRIPTION_EVENT_SINK_INPUT, 0, i.index, e.data());
+}
+
+void EventTrace::info(const pa_source_output_info &i) {
+    Encoder e;
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+    e.common(i.name, nullptr, i.proplist, &i.channel_map, &i.volume, i.mute,
+             0, 0, PA_INVALID_INDEX, i.source, i.client);
+#else
+    e.common(i.name, nullptr, i.proplist, &i.channel_map, nullptr, 0,
+             0, 0, PA_INVALID_INDEX, i.source, i.client);
+#endif
+    e.noPorts();
+    e.noProfiles();
+    write(InfoRecord, PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT, 0, i.index, e.data());
+}
+
+void EventTrace::info(const pa_client_info &i) {
+    Encoder e;
+    e.common(i.name, nullptr, i.proplist, nullptr, nullptr, 0, 0, 0, PA_INVALID_INDEX, PA_INVALID_INDEX, PA_INVALID_INDEX);
+    e.noPorts();
+    e.noProfiles();
+    write(InfoRecord, PA_SUBSCRIPTION_EVENT_CLIENT, 0, i.index, e.data());
+}
+
+void EventTrace::info(const pa_server_info &i) {
+    Encoder e;
+    e.common(i.default_sink_name, i.default_source_name, nullptr, &i.channel_map, nullptr, 0,
+             0, 0, PA_INVALID_INDEX, PA_INVALID_INDEX, PA_INVALID_INDEX);
+    e.noPorts();
+    e.noProfiles();
+    write(InfoRecord, PA_SUBSCRIPTION_EVENT_SERVER, 0, PA_INVALID_INDEX, e.data());
+}
+
+bool EventTrace::decode(const RecordHeader &r, Object *o) {
+    if (r.type != InfoRecord)
+        return false;
+
+    Decoder d(Reader::payload(&r), r.size);
+
+    o->name = d.string();
+    o->description = d.string();
+    o->proplist.clear();
+    for (uint32_t n = d.count(); n > 0; n--) {
+        const QByteArray key = d.string();
+        o->proplist.append(qMakePair(key, d.string()));
+    }
+    d.channelMap(&o->channelMap);
+    d.volume(&o->volume);
+    o->mute = d.i32();
+    o->flags = d.u32();
+    o->baseVolume = d.u32();
+    o->card = d.u32();
+    o->peer = d.u32();
+    o->client = d.u32();
+
+    o->ports.clear();
+    for (uint32_t n = d.count(); n > 0; n--) {
+        Port p;
+        p.name = d.string();
+        p.description = d.string();
+        p.priority = d.u32();
+        p.available = d.i32();
+        p.direction = d.i32();
+        p.latencyOffset = d.i64();
+        for (uint32_t k = d.count(); k > 0; k--)
+            p.profiles.append(d.string());
+        o->ports.append(p);
+    }
+    o->activePort = d.string();
+
+    o->profiles.clear();
+    for (uint32_t n = d.count(); n > 0; n--) {
+        Profile p;
+        p.name = d.string();
+        p.description = d.string();
+        p.nSinks = d.u32();
+        p.nSources = d.u32();
+        p.priority = d.u32();
+        p.available = d.i32();
+        o->profiles.append(p);
+    }
+    o->activeProfile = d.string();
+
+    return d.ok();
+}
+
+/*** EventTrace::Reader ***/
+
+bool EventTrace::Reader::open(const QString &path, QString *error) {
+    mFile.setFileName(path);
+    if (!mFile.open(QIODevice::ReadOnly)) {
+        *error = QCoreApplication::translate("EventTrace", "Cannot read %1: %2").arg(path, mFile.errorString());
+        return false;
+    }
+
+    mSize = mFile.size();
+    mData = mSize >= (qint64) sizeof(FileHeader) ? mFile.map(0, mSize) : nullptr;
+    const FileHeader *h = reinterpret_cast<const FileHeader*>(mData);
+    if (!h || memcmp(h->magic, magic, sizeof(magic)) != 0) {
+        *error = QCoreApplication::translate("EventTrace", "%1 is not a trace").arg(path);
+        return false;
+    }
+    if (h->version != Version || h->headerSize < sizeof(FileHeader) || h->headerSize % 8 != 0) {
+        *error = QCoreApplication::translate("EventTrace", "%1 has an unsupported trace version").arg(path);
+        return false;
+    }
+
+    mFirst = h->headerSize;
+    return true;
+}
+
+const EventTrace::RecordHeader *EventTrace::Reader::record(qint64 offset) const {
+    if (offset < mFirst || offset + (qint64) sizeof(RecordHeader) > mSize)
+        return nullptr;
+
+    const RecordHeader *r = reinterpret_cast<const RecordHeader*>(mData + offset);
+    /* a recording that was cut short ends in the middle of a record */
+    if (offset + (qint64) sizeof(RecordHeader) + r->size > mSize)
+        return nullptr;
+    return r;
+}
+
+qint64 EventTrace::Reader::next(qint64 offset) const {
+    const RecordHeader *r = record(offset);
+    return r ? offset + sizeof(RecordHeader) + ((r->size + 7) & ~7u) : mSize;
+}
@@ -0,0 +1,161 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef eventtrace_h
+#define eventtrace_h
+
+#include <pulse/pulseaudio.h>
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <stdint.h>
+
+// A binary trace of what the server told us: the subscription events, the
+// info records that answered them and the peak meter samples, each with the
+// time it came in. --record-trace writes one; the libpulse stand-in in
+// src/benchmarks replays it (see pulseshim.cc), so that a slow session can
+// be reproduced offline and fixes measured against it.
+//
+// The file is a FileHeader followed by records, each a RecordHeader and its
+// payload padded to 8 bytes, so that a mapped trace can be walked in place.
+// Numbers are in the byte order of the machine that made the recording.
+class EventTrace {
+public:
+    enum RecordType {
+        // the context became ready; no payload
+        ConnectedRecord = 1,
+        // a subscription event; no payload
+        EventRecord,
+        // an info record, see Object
+        InfoRecord,
+        // a peak meter sample, see MeterSample
+        MeterRecord
+    };
+
+    static constexpr uint32_t Version = 1;
+
+    struct FileHeader {
+        char magic[8];          // "PVCTRACE"
+        uint32_t version;
+        uint32_t headerSize;    // where the first record starts
+        uint64_t startTime;     // of the recording, in µs since the epoch
+    };
+
+    struct RecordHeader {
+        uint64_t time;          // in µs since the recording started
+        uint8_t type;           // RecordType
+        uint8_t facility;       // PA_SUBSCRIPTION_EVENT_SINK ... _CARD
+        uint16_t event;         // PA_SUBSCRIPTION_EVENT_NEW, _CHANGE or _REMOVE
+        uint32_t index;         // of the object; of the source for meter samples
+        uint32_t size;          // of the payload, without the padding
+        uint32_t reserved;
+    };
+
+    struct MeterSample {
+        uint32_t stream;        // the monitored sink input, or PA_INVALID_INDEX
+        float value;
+    };
+
+    struct Port {
+        QByteArray name;
+        QByteArray description;
+        uint32_t priority;
+        int32_t available;
+        int32_t direction;
+        int64_t latencyOffset;
+        // for card ports, the profiles they belong to
+        QList<QByteArray> profiles;
+    };
+
+    struct Profile {
+        QByteArray name;
+        QByteArray description;
+        uint32_t nSinks;
+        uint32_t nSources;
+        uint32_t priority;
+        int32_t available;
+    };
+
+    // The part of an info record that the window and the command line modes
+    // use. What a field means depends on the facility; for the server, name
+    // and description are the default sink and source.
+    struct Object {
+        QByteArray name;
+        QByteArray description;
+        QList<QPair<QByteArray, QByteArray> > proplist;
+        pa_channel_map channelMap;
+        pa_cvolume volume;
+        int32_t mute;
+        uint32_t flags;
+        uint32_t baseVolume;
+        uint32_t card;
+        // a sink's monitor, a monitor's sink, a stream's device
+        uint32_t peer;
+        uint32_t client;
+        QList<Port> ports;
+        QByteArray activePort;
+        QList<Profile> profiles;
+        QByteArray activeProfile;
+    };
+
+    // Recording. Everything is written from the mainloop callbacks, through
+    // a file buffer that is flushed about once a second.
+    static bool start(const QString &path, QString *error);
+    static void stop();
+    static bool recording() { return file != nullptr; }
+
+    static void connected();
+    static void event(pa_subscription_event_type_t t, uint32_t index);
+    static void info(const pa_card_info &i);
+    static void info(const pa_sink_info &i);
+    static void info(const pa_source_info &i);
+    static void info(const pa_sink_input_info &i);
+    static void info(const pa_source_output_info &i);
+    static void info(const pa_client_info &i);
+    static void info(const pa_server_info &i);
+    static void meterSample(uint32_t source, uint32_t stream, float value);
+
+    // Reading. Records are addressed by their offset in the file.
+    class Reader {
+    public:
+        bool open(const QString &path, QString *error);
+
+        qint64 first() const { return mFirst; }
+        // the record at offset, or nullptr if there is none
+        const RecordHeader *record(qint64 offset) const;
+        qint64 next(qint64 offset) const;
+
+        static const char *payload(const RecordHeader *r) { return reinterpret_cast<const char*>(r + 1); }
+
+    private:
+        QFile mFile;
+        const uchar *mData = nullptr;
+        qint64 mSize = 0;
+        qint64 mFirst = 0;
+    };
+
+    static bool decode(const RecordHeader &r, Object *o);
+
+private:
+    static void write(RecordType type, int facility, int event, uint32_t index, const QByteArray &payload);
+
+    static QFile *file;
+};
+
+#endif
@@ -0,0 +1,187 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "fadescheduler.h"
+#include "operationstats.h"
+#include <pulse/rtclock.h>
+#include <QSettings>
+
+#define DEFAULT_STEP_INTERVAL 20
+
+FadeScheduler *FadeScheduler::instance() {
+    /* never destroyed: its timer may not outlive the mainloop */
+    static FadeScheduler *scheduler = new FadeScheduler;
+    return scheduler;
+}
+
+FadeScheduler::FadeScheduler() :
+    mTimer(nullptr),
+    mStepInterval(DEFAULT_STEP_INTERVAL) {
+
+    const QSettings config;
+    setStepInterval(config.value(QStringLiteral("fades/stepInterval"), DEFAULT_STEP_INTERVAL).toInt());
+}
+
+void FadeScheduler::setStepInterval(int ms) {
+    mStepInterval = qBound(5, ms, 1000);
+}
+
+void FadeScheduler::fade(Target target, uint32_t index, const pa_cvolume &from, const pa_cvolume &to, int durationMs) {
+    LOCK_MAINLOOP;
+
+    auto it = mFades.find(Key(target, index));
+    if (it == mFades.end()) {
+        it = mFades.insert(std::make_pair(Key(target, index), Fade())).first;
+        it->second.operation = nullptr;
+    }
+
+    /* an update still in flight for a replaced fade delays the first step of this one */
+    Fade &f = it->second;
+    f.to = to;
+    f.from = from;
+    if (f.from.channels != to.channels)
+        pa_cvolume_set(&f.from, to.channels, from.channels ? pa_cvolume_max(&from) : to.values[0]);
+    f.start = pa_rtclock_now();
+    f.duration = qMax(durationMs, 1) * PA_USEC_PER_MSEC;
+
+    if (!mTimer)
+        schedule();
+}
+
+void FadeScheduler::cancel(Target target, uint32_t index) {
+    LOCK_MAINLOOP;
+
+    auto it = mFades.find(Key(target, index));
+    if (it == mFades.end())
+        return;
+
+    if (it->second.operation)
+        pa_operation_unref(it->second.operation);
+    mFades.erase(it);
+}
+
+void FadeScheduler::cancelAll() {
+    LOCK_MAINLOOP;
+
+    for (auto &it : mFades) {
+        if (it.second.operation)
+            pa_operation_unref(it.second.operation);
+    }
+    mFades.clear();
+    schedule();
+}
+
+bool FadeScheduler::isFading(Target target, uint32_t index) const {
+    LOCK_MAINLOOP;
+
+    return mFades.count(Key(target, index)) > 0;
+}
+
+void FadeScheduler::schedule() {
+    pa_context *c = get_context();
+
+    if (!c || mFades.empty()) {
+        if (mTimer) {
+            get_mainloop_api()->time_free(mTimer);
+            mTimer = nullptr;
+        }
+        return;
+    }
+
+    const pa_usec_t next = pa_rtclock_now() + (pa_usec_t) mStepInterval * PA_USEC_PER_MSEC;
+    if (mTimer)
+        pa_context_rttime_restart(c, mTimer, next);
+    else
+        mTimer = pa_context_rttime_new(c, next, timeCallback, this);
+}
+
+void FadeScheduler::timeCallback(pa_mainloop_api *, pa_time_event *, const struct timeval *, void *userdata) {
+    static_cast<FadeScheduler*>(userdata)->step();
+}
+
+void FadeScheduler::step() {
+    const pa_usec_t now = pa_rtclock_now();
+
+    for (auto it = mFades.begin(); it != mFades.end(); ) {
+        Fade &f = it->second;
+
+        if (f.operation) {
+            /* the server has not caught up with the previous step yet */
+            if (pa_operation_get_state(f.operation) == PA_OPERATION_RUNNING) {
+                ++it;
+                continue;
+            }
+            pa_operation_unref(f.operation);
+            f.operation = nullptr;
+        }
+
+        const bool last = now >= f.start + f.duration;
+        pa_cvolume v = f.to;
+        if (!last) {
+            const double t = (double) (now - f.start) / f.duration;
+            for (int i = 0; i < v.channels; i++)
+                v.values[i] = (pa_volume_t) (f.from.values[i] + t * ((double) f.to.values[i] - f.from.values[i]) + 0.5);
+        }
+
+        f.operation = setVolume(static_cast<Target>(it->first.first), it->first.second, v);
+        if (last || !f.operation) {
+            if (f.operation)
+                pa_operation_unref(f.operation);
+            it = mFades.erase(it);
+        } else
+            ++it;
+    }
+
+    schedule();
+}
+
+pa_operation *FadeScheduler::setVolume(Target target, uint32_t index, const pa_cvolume &v) {
+    pa_context *c = get_context();
+    pa_operation *o = nullptr;
+
+    if (!c || pa_context_get_state(c) != PA_CONTEXT_READY)
+        return nullptr;
+
+    OperationStats::Tracker t(OperationStats::SetVolume);
+    switch (target) {
+        case Sink:
+            o = pa_context_set_sink_volume_by_index(c, index, &v, t.callback(), t.userdata());
+            break;
+        case Source:
+            o = pa_context_set_source_volume_by_index(c, index, &v, t.callback(), t.userdata());
+            break;
+        case SinkInput:
+            o = pa_context_set_sink_input_volume(c, index, &v, t.callback(), t.userdata());
+            break;
+        case SourceOutput:
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+            o = pa_context_set_source_output_volume(c, index, &v, t.callback(), t.userdata());
+#endif
+            break;
+    }
+
+    /* the target went away, or the connection: the fade ends here */
+    if (!o)
+        return nullptr;
+
+    t.attach(o);
+    return o;
+}
@@ -0,0 +1,79 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef fadescheduler_h
+#define fadescheduler_h
+
+#include "pavucontrol.h"
+#include <map>
+#include <utility>
+
+// Runs volume fades and ramps in the PulseAudio mainloop. With the threaded
+// mainloop (USE_THREADED_PALOOP) they run on its thread and stay smooth
+// however busy the GUI thread is; with the glib mainloop used elsewhere they
+// share the GUI thread, and a long stall there delays a step like any other
+// event. All fades share one mainloop timer which, every step
+// interval, sends each fade its interpolated volume. A fade whose previous
+// update has not completed yet skips the step, so the effective step rate
+// follows the latency of the server instead of queueing requests up.
+//
+// The widgets learn about the intermediate volumes from the server's change
+// events, like for any other client. A volume set by hand, or the target
+// going away, cancels its fade.
+class FadeScheduler {
+public:
+    enum Target {
+        Sink,
+        Source,
+        SinkInput,
+        SourceOutput,
+    };
+
+    static FadeScheduler *instance();
+
+    // the step interval, in ms; "fades/stepInterval" in the settings file
+    int stepInterval() const { return mStepInterval; }
+    void setStepInterval(int ms);
+
+    // fades the volume of target from `from` to `to` in durationMs,
+    // replacing any fade of the same target still in progress
+    void fade(Target target, uint32_t index, const pa_cvolume &from, const pa_cvolume &to, int durationMs);
+    void cancel(Target target, uint32_t index);
+    void cancelAll();
+    bool isFading(Target target, uint32_t index) const;
+
+private:
+    FadeScheduler();
+
+    struct Fade {
+        pa_cvolume from, to;
+        pa_usec_t start, duration;
+        pa_operation *operation;
+    };
+    typedef std::pair<int, uint32_t> Key;
+
+    void schedule();
+    void step();
+    static void timeCallback(pa_mainloop_api *a, pa_time_event *e, const struct timeval *tv, void *userdata);
+    static pa_operation *setVolume(Target target, uint32_t index, const pa_cvolume &v);
+
+    std::map<Key, Fade> mFades;
+    pa_time_event *mTimer;
+    int mStepInterval;
+};
+
+#endif
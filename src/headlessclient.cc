@@ -0,0 +1,62 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "headlessclient.h"
+#include <stdio.h>
+
+static const char *const headlessOptions[] = {
+    "--dump-json",
+    "--apply",
+    "--watch",
+};
+
+HeadlessClient::~HeadlessClient() {
+}
+
+void HeadlessClient::remove(int, uint32_t) {
+}
+
+void HeadlessClient::connectionFailed() {
+    fprintf(stderr, "%s: %s\n", QObject::tr("Connection to PulseAudio failed").toLocal8Bit().constData(),
+            get_context() ? pa_strerror(pa_context_errno(get_context())) : "");
+    qApp->exit(1);
+}
+
+pa_subscription_mask_t HeadlessClient::subscriptionMask() const {
+    return (pa_subscription_mask_t) (PA_SUBSCRIPTION_MASK_SINK|
+                                     PA_SUBSCRIPTION_MASK_SOURCE|
+                                     PA_SUBSCRIPTION_MASK_SINK_INPUT|
+                                     PA_SUBSCRIPTION_MASK_SOURCE_OUTPUT|
+                                     PA_SUBSCRIPTION_MASK_CLIENT|
+                                     PA_SUBSCRIPTION_MASK_SERVER|
+                                     PA_SUBSCRIPTION_MASK_CARD);
+}
+
+bool HeadlessClient::isHeadlessArgument(const char *arg) {
+    for (const char *option : headlessOptions) {
+        const size_t len = strlen(option);
+        /* both "--option value" and "--option=value" */
+        if (strncmp(arg, option, len) == 0 && (arg[len] == '\0' || arg[len] == '='))
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,60 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef headlessclient_h
+#define headlessclient_h
+
+#include "pavucontrol.h"
+#include <pulse/ext-stream-restore.h>
+
+// Takes the place of the MainWindow in the command line modes: it receives
+// the results of the same enumeration (see context_state_callback()), on the
+// main thread, without any widget being created. The application runs on the
+// offscreen platform then, so that these modes never open the display.
+class HeadlessClient {
+public:
+    virtual ~HeadlessClient();
+
+    virtual void updateCard(const pa_card_info &) {}
+    virtual void updateSink(const pa_sink_info &) {}
+    virtual void updateSource(const pa_source_info &) {}
+    virtual void updateSinkInput(const pa_sink_input_info &) {}
+    virtual void updateSourceOutput(const pa_source_output_info &) {}
+    virtual void updateClient(const pa_client_info &) {}
+    virtual void updateServer(const pa_server_info &) {}
+    virtual void updateRole(const pa_ext_stream_restore_info &) {}
+
+    // facility is one of the PA_SUBSCRIPTION_EVENT_* facilities
+    virtual void remove(int facility, uint32_t index);
+
+    // a subscription event as subscribe_cb() received it, before the info
+    // query it calls for (if any) is answered through the update functions
+    virtual void subscriptionEvent(pa_subscription_event_type_t, uint32_t) {}
+
+    // the initial enumeration is complete
+    virtual void enumerationDone() = 0;
+    // the connection failed or was lost; exits with an error by default
+    virtual void connectionFailed();
+
+    // the events to subscribe to once connected; all of them by default
+    virtual pa_subscription_mask_t subscriptionMask() const;
+
+    // the command line arguments that select a headless mode
+    static bool isHeadlessArgument(const char *arg);
+};
+
+#endif
@@ -0,0 +1,226 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "iconcache.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QIcon>
+#include <QImage>
+#include <QLabel>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStyle>
+#include <QTimer>
+
+// the dynamic property holding the key of the icon a label shows or waits for
+static const char iconKeyProperty[] = "pvcIconKey";
+
+// the theme every other one implicitly inherits from
+static const char fallbackTheme[] = "hicolor";
+
+// Renders an icon through QIcon, which must only happen on the GUI thread.
+static QPixmap renderThemeIcon(const QString &name, const QString &fallback, int size) {
+    QIcon icon = QIcon::fromTheme(name);
+    if (icon.isNull() || icon.availableSizes().isEmpty())
+        icon = QIcon::fromTheme(fallback);
+    return icon.pixmap(size, size);
+}
+
+// The latest modification time of a theme's top directories and index files,
+// in ms since the epoch; 0 when the theme is not installed.
+static qint64 themeStamp(const QString &theme) {
+    qint64 stamp = 0;
+
+    const QStringList paths = QIcon::themeSearchPaths();
+    for (const auto &path : paths) {
+        const QFileInfo dir(path + QLatin1Char('/') + theme);
+        if (!dir.isDir())
+            continue;
+        stamp = qMax(stamp, dir.lastModified().toMSecsSinceEpoch());
+
+        const QFileInfo index(dir.filePath() + QStringLiteral("/index.theme"));
+        if (index.exists())
+            stamp = qMax(stamp, index.lastModified().toMSecsSinceEpoch());
+    }
+
+    return stamp;
+}
+
+namespace {
+
+class SaveTask : public QRunnable {
+public:
+    SaveTask(const QImage &image, const QString &file) : mImage(image), mFile(file) {}
+
+    void run() override {
+        QDir().mkpath(QFileInfo(mFile).absolutePath());
+
+        /* Written next to the final name and renamed into place, so that a
+         * later session never loads a partly written file */
+        QSaveFile file(mFile);
+        if (file.open(QIODevice::WriteOnly) && mImage.save(&file, "PNG"))
+            file.commit();
+    }
+
+private:
+    const QImage mImage;
+    const QString mFile;
+};
+
+} // namespace
+
+IconCache::IconCache(QObject *parent) :
+    QObject(parent) {
+
+    setTheme(QIcon::themeName());
+
+    // a single worker is plenty for writing the few icons of a session
+    mPool.setMaxThreadCount(1);
+}
+
+IconCache::~IconCache() {
+    mPool.clear();
+    mPool.waitForDone();
+}
+
+void IconCache::setTheme(const QString &theme) {
+    mTheme = theme;
+    mPixmaps.clear();
+    mCacheDir.clear();
+
+    const QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (base.isEmpty())
+        return;
+
+    const QString themeCache = base + QStringLiteral("/icons/") + (theme.isEmpty() ? QStringLiteral("default") : theme);
+    const QString stamp = QString::number(themeStamp(theme.isEmpty() ? QLatin1String(fallbackTheme) : theme));
+    mCacheDir = themeCache + QLatin1Char('/') + stamp;
+
+    /* Drop what was rendered from earlier versions of the theme */
+    const QDir dir(themeCache);
+    const QStringList entries = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const auto &entry : entries) {
+        if (entry != stamp)
+            QDir(dir.filePath(entry)).removeRecursively();
+    }
+}
+
+QString IconCache::cacheFile(const QString &name, const QString &fallback, int size, qreal dpr) const {
+    if (mCacheDir.isEmpty())
+        return QString();
+
+    QString file = name.isEmpty() ? QStringLiteral("_") : name;
+    if (!fallback.isEmpty())
+        file += QLatin1Char('~') + fallback;
+    file.replace(QLatin1Char('/'), QLatin1Char('_'));
+
+    return mCacheDir + QLatin1Char('/') + QString::number(size) + QLatin1Char('@') + QString::number(dpr)
+        + QStringLiteral("x/") + file + QStringLiteral(".png");
+}
+
+QPixmap IconCache::placeholder(int size, qreal dpr) {
+    const QString key = QString::number(size) + QLatin1Char('@') + QString::number(dpr);
+    auto it = mPlaceholders.constFind(key);
+    if (it != mPlaceholders.constEnd())
+        return *it;
+
+    QPixmap pix(qRound(size * dpr), qRound(size * dpr));
+    pix.setDevicePixelRatio(dpr);
+    pix.fill(Qt::transparent);
+    mPlaceholders.insert(key, pix);
+    return pix;
+}
+
+void IconCache::setIcon(QLabel *label, const char *name, const char *fallback) {
+    const QString theme = QIcon::themeName();
+    if (theme != mTheme)
+        setTheme(theme);
+
+    const int size = label->style()->pixelMetric(QStyle::PM_ToolBarIconSize);
+    const qreal dpr = qGuiApp->devicePixelRatio();
+    const QString iconName = QString::fromLatin1(name);
+    const QString fallbackName = QString::fromLatin1(fallback);
+    const QString key = theme + QLatin1Char('|') + iconName + QLatin1Char('|') + fallbackName + QLatin1Char('|')
+        + QString::number(size) + QLatin1Char('@') + QString::number(dpr);
+
+    /* Widgets are updated far more often than their icon changes */
+    if (label->property(iconKeyProperty).toString() == key)
+        return;
+    label->setProperty(iconKeyProperty, key);
+
+    auto it = mPixmaps.constFind(key);
+    if (it != mPixmaps.constEnd()) {
+        label->setPixmap(*it);
+        return;
+    }
+
+    const QString file = cacheFile(iconName, fallbackName, size, dpr);
+    QImage image;
+    if (!file.isEmpty() && image.load(file, "PNG")) {
+        image.setDevicePixelRatio(dpr);
+        const QPixmap pix = QPixmap::fromImage(image);
+        mPixmaps.insert(key, pix);
+        label->setPixmap(pix);
+        return;
+    }
+
+    label->setPixmap(placeholder(size, dpr));
+
+    auto pending = mPending.find(key);
+    if (pending != mPending.end()) {
+        pending->labels.append(label);
+        return;
+    }
+
+    if (mPending.isEmpty())
+        QTimer::singleShot(0, this, &IconCache::renderPending);
+
+    Request &request = mPending[key];
+    request.name = iconName;
+    request.fallback = fallbackName;
+    request.file = file;
+    request.size = size;
+    request.labels.append(label);
+}
+
+void IconCache::renderPending() {
+    const QHash<QString, Request> pending = mPending;
+    mPending.clear();
+
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+        const Request &request = it.value();
+        const QPixmap pix = renderThemeIcon(request.name, request.fallback, request.size);
+
+        if (!pix.isNull() && !request.file.isEmpty())
+            mPool.start(new SaveTask(pix.toImage(), request.file));
+
+        mPixmaps.insert(it.key(), pix);
+
+        const auto &labels = request.labels;
+        for (const auto &label : labels) {
+            if (label && label->property(iconKeyProperty).toString() == it.key())
+                label->setPixmap(pix);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef iconcache_h
+#define iconcache_h
+
+#include <QObject>
+#include <QHash>
+#include <QPixmap>
+#include <QPointer>
+#include <QThreadPool>
+#include <QVector>
+
+class QLabel;
+
+// Resolves the theme icons shown by the card, device and stream widgets.
+// Lookups are memoized per (theme, name, fallback, size). Icons that have not
+// been rendered yet are rendered through QIcon (which may only be used on the
+// GUI thread) once control returns to the event loop, so that building the
+// widgets isn't held up by it; until then the label shows a blank placeholder
+// of the final size.
+// Rendered icons are also kept as PNG files in the user's cache directory, per
+// icon theme and size, so that later sessions need no SVG rendering to show
+// them; a worker thread writes them. That cache is dropped whenever the theme's
+// index.theme or top directory change.
+class IconCache : public QObject {
+    Q_OBJECT
+public:
+    explicit IconCache(QObject *parent = nullptr);
+    ~IconCache() override;
+
+    void setIcon(QLabel *label, const char *name, const char *fallback = nullptr);
+
+private Q_SLOTS:
+    void renderPending();
+
+private:
+    struct Request {
+        QString name, fallback, file;
+        int size;
+        QVector<QPointer<QLabel>> labels;
+    };
+
+    void setTheme(const QString &theme);
+    QString cacheFile(const QString &name, const QString &fallback, int size, qreal dpr) const;
+    QPixmap placeholder(int size, qreal dpr);
+
+    QHash<QString, QPixmap> mPixmaps;
+    QHash<QString, QPixmap> mPlaceholders;
+    QHash<QString, Request> mPending;
+    QString mTheme;
+    QString mCacheDir;
+    QThreadPool mPool;
+};
+
+#endif
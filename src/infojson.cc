@@ -0,0 +1,205 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "infojson.h"
+#include <QJsonArray>
+
+static inline QJsonValue str(const char *s) {
+    return s ? QJsonValue(QString::fromUtf8(s)) : QJsonValue();
+}
+
+static inline QJsonValue idx(uint32_t index) {
+    return index == PA_INVALID_INDEX ? QJsonValue() : QJsonValue((qint64) index);
+}
+
+static QJsonArray volume(const pa_cvolume &v) {
+    QJsonArray a;
+    for (int i = 0; i < v.channels; i++)
+        a.append((qint64) v.values[i]);
+    return a;
+}
+
+static QJsonValue channelMap(const pa_channel_map &map) {
+    char buf[PA_CHANNEL_MAP_SNPRINT_MAX];
+    return str(pa_channel_map_snprint(buf, sizeof(buf), &map));
+}
+
+static QJsonValue sampleSpec(const pa_sample_spec &spec) {
+    char buf[PA_SAMPLE_SPEC_SNPRINT_MAX];
+    return str(pa_sample_spec_snprint(buf, sizeof(buf), &spec));
+}
+
+QJsonObject InfoJson::proplist(pa_proplist *p) {
+    QJsonObject o;
+    void *state = nullptr;
+    const char *key;
+
+    while ((key = pa_proplist_iterate(p, &state))) {
+        const char *value = pa_proplist_gets(p, key);
+        /* binary properties (e.g. icons) are left out */
+        if (value)
+            o[QString::fromUtf8(key)] = QString::fromUtf8(value);
+    }
+
+    return o;
+}
+
+QJsonObject InfoJson::server(const pa_server_info &info) {
+    QJsonObject o;
+    o[QStringLiteral("name")] = str(info.server_name);
+    o[QStringLiteral("version")] = str(info.server_version);
+    o[QStringLiteral("host")] = str(info.host_name);
+    o[QStringLiteral("user")] = str(info.user_name);
+    o[QStringLiteral("sampleSpec")] = sampleSpec(info.sample_spec);
+    o[QStringLiteral("channelMap")] = channelMap(info.channel_map);
+    o[QStringLiteral("defaultSink")] = str(info.default_sink_name);
+    o[QStringLiteral("defaultSource")] = str(info.default_source_name);
+    return o;
+}
+
+QJsonObject InfoJson::client(const pa_client_info &info) {
+    QJsonObject o;
+    o[QStringLiteral("index")] = idx(info.index);
+    o[QStringLiteral("name")] = str(info.name);
+    o[QStringLiteral("module")] = idx(info.owner_module);
+    o[QStringLiteral("driver")] = str(info.driver);
+    o[QStringLiteral("properties")] = proplist(info.proplist);
+    return o;
+}
+
+QJsonObject InfoJson::card(const pa_card_info &info) {
+    QJsonObject o;
+    o[QStringLiteral("index")] = idx(info.index);
+    o[QStringLiteral("name")] = str(info.name);
+    o[QStringLiteral("driver")] = str(info.driver);
+
+    QJsonArray profiles;
+    for (uint32_t i = 0; i < info.n_profiles; ++i) {
+        const pa_card_profile_info2 *p = info.profiles2[i];
+        QJsonObject profile;
+        profile[QStringLiteral("name")] = str(p->name);
+        profile[QStringLiteral("description")] = str(p->description);
+        profile[QStringLiteral("priority")] = (qint64) p->priority;
+        profile[QStringLiteral("available")] = p->available != 0;
+        profiles.append(profile);
+    }
+    o[QStringLiteral("profiles")] = profiles;
+    o[QStringLiteral("activeProfile")] = info.active_profile2 ? str(info.active_profile2->name) : QJsonValue();
+
+    QJsonArray ports;
+    for (uint32_t i = 0; i < info.n_ports; ++i) {
+        const pa_card_port_info *p = info.ports[i];
+        QJsonObject port;
+        port[QStringLiteral("name")] = str(p->name);
+        port[QStringLiteral("description")] = str(p->description);
+        port[QStringLiteral("direction")] = p->direction == PA_DIRECTION_OUTPUT ? QStringLiteral("output") : QStringLiteral("input");
+        port[QStringLiteral("available")] = p->available;
+        port[QStringLiteral("latencyOffset")] = (qint64) p->latency_offset;
+        ports.append(port);
+    }
+    o[QStringLiteral("ports")] = ports;
+
+    o[QStringLiteral("properties")] = proplist(info.proplist);
+    return o;
+}
+
+template <typename Info>
+static QJsonObject device(const Info &info) {
+    QJsonObject o;
+    o[QStringLiteral("index")] = idx(info.index);
+    o[QStringLiteral("name")] = str(info.name);
+    o[QStringLiteral("description")] = str(info.description);
+    o[QStringLiteral("card")] = idx(info.card);
+    o[QStringLiteral("sampleSpec")] = sampleSpec(info.sample_spec);
+    o[QStringLiteral("channelMap")] = channelMap(info.channel_map);
+    o[QStringLiteral("volume")] = volume(info.volume);
+    o[QStringLiteral("baseVolume")] = (qint64) info.base_volume;
+    o[QStringLiteral("mute")] = info.mute != 0;
+    o[QStringLiteral("state")] = (int) info.state;
+
+    QJsonArray ports;
+    for (uint32_t i = 0; i < info.n_ports; ++i) {
+        QJsonObject port;
+        port[QStringLiteral("name")] = str(info.ports[i]->name);
+        port[QStringLiteral("description")] = str(info.ports[i]->description);
+        port[QStringLiteral("available")] = info.ports[i]->available;
+        ports.append(port);
+    }
+    o[QStringLiteral("ports")] = ports;
+    o[QStringLiteral("activePort")] = info.active_port ? str(info.active_port->name) : QJsonValue();
+
+    o[QStringLiteral("properties")] = proplist(info.proplist);
+    return o;
+}
+
+QJsonObject InfoJson::sink(const pa_sink_info &info) {
+    QJsonObject o = device(info);
+    o[QStringLiteral("monitorSource")] = idx(info.monitor_source);
+    return o;
+}
+
+QJsonObject InfoJson::source(const pa_source_info &info) {
+    QJsonObject o = device(info);
+    o[QStringLiteral("monitorOfSink")] = idx(info.monitor_of_sink);
+    return o;
+}
+
+QJsonObject InfoJson::sinkInput(const pa_sink_input_info &info) {
+    QJsonObject o;
+    o[QStringLiteral("index")] = idx(info.index);
+    o[QStringLiteral("name")] = str(info.name);
+    o[QStringLiteral("client")] = idx(info.client);
+    o[QStringLiteral("sink")] = idx(info.sink);
+    o[QStringLiteral("sampleSpec")] = sampleSpec(info.sample_spec);
+    o[QStringLiteral("channelMap")] = channelMap(info.channel_map);
+    o[QStringLiteral("volume")] = volume(info.volume);
+    o[QStringLiteral("mute")] = info.mute != 0;
+    o[QStringLiteral("corked")] = info.corked != 0;
+    o[QStringLiteral("properties")] = proplist(info.proplist);
+    return o;
+}
+
+QJsonObject InfoJson::sourceOutput(const pa_source_output_info &info) {
+    QJsonObject o;
+    o[QStringLiteral("index")] = idx(info.index);
+    o[QStringLiteral("name")] = str(info.name);
+    o[QStringLiteral("client")] = idx(info.client);
+    o[QStringLiteral("source")] = idx(info.source);
+    o[QStringLiteral("sampleSpec")] = sampleSpec(info.sample_spec);
+    o[QStringLiteral("channelMap")] = channelMap(info.channel_map);
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+    o[QStringLiteral("volume")] = volume(info.volume);
+    o[QStringLiteral("mute")] = info.mute != 0;
+#endif
+    o[QStringLiteral("corked")] = info.corked != 0;
+    o[QStringLiteral("properties")] = proplist(info.proplist);
+    return o;
+}
+
+QJsonObject InfoJson::role(const pa_ext_stream_restore_info &info) {
+    QJsonObject o;
+    o[QStringLiteral("name")] = str(info.name);
+    o[QStringLiteral("channelMap")] = channelMap(info.channel_map);
+    o[QStringLiteral("volume")] = volume(info.volume);
+    o[QStringLiteral("device")] = str(info.device);
+    o[QStringLiteral("mute")] = info.mute != 0;
+    return o;
+}
@@ -0,0 +1,42 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef infojson_h
+#define infojson_h
+
+#include "pavucontrol.h"
+#include <pulse/ext-stream-restore.h>
+#include <QJsonObject>
+
+// JSON renderings of the introspection results, as written by the command
+// line modes. Volumes are arrays of raw pa_volume_t values, one per channel,
+// with the channel map alongside; proplists become objects of strings.
+class InfoJson {
+public:
+    static QJsonObject server(const pa_server_info &info);
+    static QJsonObject client(const pa_client_info &info);
+    static QJsonObject card(const pa_card_info &info);
+    static QJsonObject sink(const pa_sink_info &info);
+    static QJsonObject source(const pa_source_info &info);
+    static QJsonObject sinkInput(const pa_sink_input_info &info);
+    static QJsonObject sourceOutput(const pa_source_output_info &info);
+    static QJsonObject role(const pa_ext_stream_restore_info &info);
+
+    static QJsonObject proplist(pa_proplist *p);
+};
+
+#endif
@@ -0,0 +1,76 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "jsondump.h"
+#include "infojson.h"
+#include <QJsonDocument>
+#include <stdio.h>
+
+void JsonDump::updateCard(const pa_card_info &info) {
+    mCards.append(InfoJson::card(info));
+}
+
+void JsonDump::updateSink(const pa_sink_info &info) {
+    mSinks.append(InfoJson::sink(info));
+}
+
+void JsonDump::updateSource(const pa_source_info &info) {
+    mSources.append(InfoJson::source(info));
+}
+
+void JsonDump::updateSinkInput(const pa_sink_input_info &info) {
+    mSinkInputs.append(InfoJson::sinkInput(info));
+}
+
+void JsonDump::updateSourceOutput(const pa_source_output_info &info) {
+    mSourceOutputs.append(InfoJson::sourceOutput(info));
+}
+
+void JsonDump::updateClient(const pa_client_info &info) {
+    mClients.append(InfoJson::client(info));
+}
+
+void JsonDump::updateServer(const pa_server_info &info) {
+    mServer = InfoJson::server(info);
+}
+
+void JsonDump::updateRole(const pa_ext_stream_restore_info &info) {
+    mRoles.append(InfoJson::role(info));
+}
+
+void JsonDump::enumerationDone() {
+    QJsonObject root;
+    root[QStringLiteral("server")] = mServer;
+    root[QStringLiteral("clients")] = mClients;
+    root[QStringLiteral("cards")] = mCards;
+    root[QStringLiteral("sinks")] = mSinks;
+    root[QStringLiteral("sources")] = mSources;
+    root[QStringLiteral("sinkInputs")] = mSinkInputs;
+    root[QStringLiteral("sourceOutputs")] = mSourceOutputs;
+    root[QStringLiteral("streamRestore")] = mRoles;
+
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    fwrite(json.constData(), 1, json.size(), stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+
+    qApp->quit();
+}
@@ -0,0 +1,45 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef jsondump_h
+#define jsondump_h
+
+#include "headlessclient.h"
+#include <QJsonArray>
+#include <QJsonObject>
+
+// --dump-json: writes the whole audio graph as one JSON document to the
+// standard output, as soon as the initial enumeration is complete, and quits.
+class JsonDump : public HeadlessClient {
+public:
+    void updateCard(const pa_card_info &info) override;
+    void updateSink(const pa_sink_info &info) override;
+    void updateSource(const pa_source_info &info) override;
+    void updateSinkInput(const pa_sink_input_info &info) override;
+    void updateSourceOutput(const pa_source_output_info &info) override;
+    void updateClient(const pa_client_info &info) override;
+    void updateServer(const pa_server_info &info) override;
+    void updateRole(const pa_ext_stream_restore_info &info) override;
+
+    void enumerationDone() override;
+
+private:
+    QJsonObject mServer;
+    QJsonArray mClients, mCards, mSinks, mSources, mSinkInputs, mSourceOutputs, mRoles;
+};
+
+#endif
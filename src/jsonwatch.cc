@@ -0,0 +1,233 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "jsonwatch.h"
+#include "infojson.h"
+#include <pulse/timeval.h>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QStringList>
+#include <stdio.h>
+
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+static const struct {
+    const char *name;
+    int facility;
+    pa_subscription_mask_t mask;
+} facilities[] = {
+    { "sink", PA_SUBSCRIPTION_EVENT_SINK, PA_SUBSCRIPTION_MASK_SINK },
+    { "source", PA_SUBSCRIPTION_EVENT_SOURCE, PA_SUBSCRIPTION_MASK_SOURCE },
+    { "sink-input", PA_SUBSCRIPTION_EVENT_SINK_INPUT, PA_SUBSCRIPTION_MASK_SINK_INPUT },
+    { "source-output", PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT, PA_SUBSCRIPTION_MASK_SOURCE_OUTPUT },
+    { "client", PA_SUBSCRIPTION_EVENT_CLIENT, PA_SUBSCRIPTION_MASK_CLIENT },
+    { "server", PA_SUBSCRIPTION_EVENT_SERVER, PA_SUBSCRIPTION_MASK_SERVER },
+    { "card", PA_SUBSCRIPTION_EVENT_CARD, PA_SUBSCRIPTION_MASK_CARD },
+};
+
+static const char *facilityName(int facility) {
+    for (const auto &f : facilities) {
+        if (f.facility == facility)
+            return f.name;
+    }
+    return "unknown";
+}
+
+JsonWatch *JsonWatch::create(const QString &list, QString *error) {
+    unsigned mask = 0;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const QStringList names = list.split(QLatin1Char(','), Qt::SkipEmptyParts);
+#else
+    const QStringList names = list.split(QLatin1Char(','), QString::SkipEmptyParts);
+#endif
+    for (const QString &name : names) {
+        bool found = false;
+        for (const auto &f : facilities) {
+            if (name.trimmed() == QLatin1String(f.name)) {
+                mask |= 1u << f.facility;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            *error = QCoreApplication::translate("JsonWatch", "Unknown facility: %1").arg(name);
+            return nullptr;
+        }
+    }
+
+    if (!mask) {
+        for (const auto &f : facilities)
+            mask |= 1u << f.facility;
+    }
+
+    /* a log pipeline reads whole blocks: flushing is up to us */
+    setvbuf(stdout, nullptr, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+    return new JsonWatch(mask);
+}
+
+JsonWatch::JsonWatch(unsigned facilities) :
+    mFacilities(facilities),
+    mEnumerated(false) {
+
+    /* one flush per mainloop iteration, however many events it brought */
+    mFlush.setSingleShot(true);
+    mFlush.setInterval(0);
+    QObject::connect(&mFlush, &QTimer::timeout, [this]() { flush(); });
+}
+
+pa_subscription_mask_t JsonWatch::subscriptionMask() const {
+    unsigned mask = 0;
+    for (const auto &f : facilities) {
+        if (wanted(f.facility))
+            mask |= f.mask;
+    }
+    return (pa_subscription_mask_t) mask;
+}
+
+void JsonWatch::write(int facility, const char *event, uint32_t index, const QJsonObject *info) {
+    timeval tv;
+    QByteArray record;
+    record.reserve(256);
+
+    record += "{\"time\":";
+    record += QByteArray::number((qulonglong) pa_timeval_load(pa_gettimeofday(&tv)));
+    record += ",\"event\":\"";
+    record += event;
+    record += "\",\"facility\":\"";
+    record += facilityName(facility);
+    record += '"';
+    if (index != PA_INVALID_INDEX) {
+        record += ",\"index\":";
+        record += QByteArray::number(index);
+    }
+    if (info) {
+        record += ",\"info\":";
+        record += QJsonDocument(*info).toJson(QJsonDocument::Compact);
+    }
+    record += "}\n";
+
+    fwrite(record.constData(), 1, record.size(), stdout);
+
+    if (!mFlush.isActive())
+        mFlush.start();
+}
+
+void JsonWatch::flush() {
+    fflush(stdout);
+
+    /* nobody is reading any more */
+    if (ferror(stdout))
+        qApp->exit(1);
+}
+
+void JsonWatch::write(int facility, int type, uint32_t index, const QJsonObject *info) {
+    write(facility, type == PA_SUBSCRIPTION_EVENT_NEW ? "new" : "change", index, info);
+}
+
+void JsonWatch::subscriptionEvent(pa_subscription_event_type_t t, uint32_t index) {
+    const int facility = t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
+    const int type = t & PA_SUBSCRIPTION_EVENT_TYPE_MASK;
+
+    if (facility > PA_SUBSCRIPTION_EVENT_CARD || !wanted(facility))
+        return;
+    /* there is only the one, and its info has no index */
+    if (facility == PA_SUBSCRIPTION_EVENT_SERVER)
+        index = PA_INVALID_INDEX;
+
+    if (type != PA_SUBSCRIPTION_EVENT_REMOVE) {
+        mPending[qMakePair(facility, index)].append(type);
+        return;
+    }
+
+    /* the queries for the events still waiting can only fail now */
+    auto it = mPending.find(qMakePair(facility, index));
+    if (it != mPending.end()) {
+        const QVector<int> &types = *it;
+        for (int pending : types)
+            write(facility, pending, index, nullptr);
+        mPending.erase(it);
+    }
+
+    write(facility, "remove", index, nullptr);
+}
+
+void JsonWatch::update(int facility, uint32_t index, const QJsonObject &info) {
+    if (!mEnumerated) {
+        write(facility, "initial", index, &info);
+        return;
+    }
+
+    auto it = mPending.find(qMakePair(facility, index));
+    if (it == mPending.end())
+        return;
+
+    const int type = it->takeFirst();
+    if (it->isEmpty())
+        mPending.erase(it);
+
+    write(facility, type, index, &info);
+}
+
+void JsonWatch::updateCard(const pa_card_info &info) {
+    if (wanted(PA_SUBSCRIPTION_EVENT_CARD))
+        update(PA_SUBSCRIPTION_EVENT_CARD, info.index, InfoJson::card(info));
+}
+
+void JsonWatch::updateSink(const pa_sink_info &info) {
+    if (wanted(PA_SUBSCRIPTION_EVENT_SINK))
+        update(PA_SUBSCRIPTION_EVENT_SINK, info.index, InfoJson::sink(info));
+}
+
+void JsonWatch::updateSource(const pa_source_info &info) {
+    if (wanted(PA_SUBSCRIPTION_EVENT_SOURCE))
+        update(PA_SUBSCRIPTION_EVENT_SOURCE, info.index, InfoJson::source(info));
+}
+
+void JsonWatch::updateSinkInput(const pa_sink_input_info &info) {
+    if (wanted(PA_SUBSCRIPTION_EVENT_SINK_INPUT))
+        update(PA_SUBSCRIPTION_EVENT_SINK_INPUT, info.index, InfoJson::sinkInput(info));
+}
+
+void JsonWatch::updateSourceOutput(const pa_source_output_info &info) {
+    if (wanted(PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT))
+        update(PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT, info.index, InfoJson::sourceOutput(info));
+}
+
+void JsonWatch::updateClient(const pa_client_info &info) {
+    if (wanted(PA_SUBSCRIPTION_EVENT_CLIENT))
+        update(PA_SUBSCRIPTION_EVENT_CLIENT, info.index, InfoJson::client(info));
+}
+
+void JsonWatch::updateServer(const pa_server_info &info) {
+    if (wanted(PA_SUBSCRIPTION_EVENT_SERVER))
+        update(PA_SUBSCRIPTION_EVENT_SERVER, PA_INVALID_INDEX, InfoJson::server(info));
+}
+
+void JsonWatch::enumerationDone() {
+    mEnumerated = true;
+}
+
+void JsonWatch::connectionFailed() {
+    flush();
+    HeadlessClient::connectionFailed();
+}
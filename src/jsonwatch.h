@@ -0,0 +1,80 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef jsonwatch_h
+#define jsonwatch_h
+
+#include "headlessclient.h"
+#include <QHash>
+#include <QJsonObject>
+#include <QPair>
+#include <QTimer>
+#include <QVector>
+
+// --watch: writes one line of JSON per subscription event to the standard
+// output, until interrupted:
+//
+//     {"time":<µs since the epoch>,"event":"new","facility":"sink","index":1,"info":{...}}
+//
+// The objects found by the initial enumeration are written first, as
+// "initial" events. Every subscription event then gives one record of its
+// own type: "new" and "change" records are written once the info query the
+// event caused is answered and carry the object as --dump-json renders it,
+// "remove" records only its index. The server answers in the order it is
+// asked, and all the enumeration queries are sent before any event query, so
+// the answers for an object pair up with its events in order. An event whose
+// object was gone before its query was answered is written without info.
+//
+// The facilities can be restricted, in which case the others are not even
+// subscribed to. Records go through a large stdio buffer that is flushed
+// once per burst of events rather than per line.
+class JsonWatch : public HeadlessClient {
+public:
+    // facilities is a comma separated list of facility names; empty for all
+    static JsonWatch *create(const QString &facilities, QString *error);
+
+    void updateCard(const pa_card_info &info) override;
+    void updateSink(const pa_sink_info &info) override;
+    void updateSource(const pa_source_info &info) override;
+    void updateSinkInput(const pa_sink_input_info &info) override;
+    void updateSourceOutput(const pa_source_output_info &info) override;
+    void updateClient(const pa_client_info &info) override;
+    void updateServer(const pa_server_info &info) override;
+
+    void subscriptionEvent(pa_subscription_event_type_t t, uint32_t index) override;
+    void enumerationDone() override;
+    void connectionFailed() override;
+
+    pa_subscription_mask_t subscriptionMask() const override;
+
+private:
+    explicit JsonWatch(unsigned facilities);
+
+    bool wanted(int facility) const { return mFacilities & (1u << facility); }
+    void update(int facility, uint32_t index, const QJsonObject &info);
+    void write(int facility, int type, uint32_t index, const QJsonObject *info);
+    void write(int facility, const char *event, uint32_t index, const QJsonObject *info);
+    void flush();
+
+    unsigned mFacilities;
+    bool mEnumerated;
+    // the types of the NEW and CHANGE events waiting for their info, per object
+    QHash<QPair<int, uint32_t>, QVector<int>> mPending;
+    QTimer mFlush;
+};
+
+#endif
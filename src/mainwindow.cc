@@ -33,10 +33,27 @@
 #include "sinkinputwidget.h"
 #include "sourceoutputwidget.h"
 #include "rolewidget.h"
-#include <QIcon>
-#include <QStyle>
+#include "iconcache.h"
+#include "devicemenu.h"
+#include "operationstatsdialog.h"
+#include "operationbatch.h"
+#include "volumegroup.h"
+#include "mixersnapshot.h"
+#include "changehistory.h"
+#include "fadescheduler.h"
+#include "portlabels.h"
+#include "metrics.h"
+#include "eventtrace.h"
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QMenu>
+#include <QMessageBox>
 #include <QSettings>
+#include <QStandardPaths>
 #include <QThread>
+#include <QToolTip>
 #ifdef USE_THREADED_PALOOP
 #include <QAbstractEventDispatcher>
 #endif
@@ -80,6 +97,8 @@ QElapsedTimer idleTimer;
 
 MainWindow::MainWindow():
     QDialog(),
+    sinkMenu(new DeviceMenu(this)),
+    sourceMenu(new DeviceMenu(this)),
     showSinkInputType(SINK_INPUT_CLIENT),
     showSinkType(SINK_ALL),
     showSourceOutputType(SOURCE_OUTPUT_CLIENT),
@@ -87,10 +106,16 @@ MainWindow::MainWindow():
     eventRoleWidget(nullptr),
     canRenameDevices(false),
     m_connected(false),
-    m_config_filename(nullptr) {
+    m_config_filename(nullptr),
+    iconCache(new IconCache(this)),
+    operationStatsDialog(nullptr),
+    volumeGroups(nullptr) {
 
     setupUi(this);
 
+    volumeGroups = new VolumeGroups(groupsVBox, noGroupsLabel);
+    connect(addGroupButton, &QPushButton::clicked, volumeGroups, &VolumeGroups::addGroupInteractively);
+
     sinkInputTypeComboBox->setCurrentIndex((int) showSinkInputType);
     sourceOutputTypeComboBox->setCurrentIndex((int) showSourceOutputType);
     sinkTypeComboBox->setCurrentIndex((int) showSinkType);
@@ -101,15 +126,49 @@ MainWindow::MainWindow():
     connect(sinkTypeComboBox, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &MainWindow::onSinkTypeComboBoxChanged);
     connect(sourceTypeComboBox, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &MainWindow::onSourceTypeComboBoxChanged);
     connect(showVolumeMetersCheckButton, &QCheckBox::toggled, this, &MainWindow::onShowVolumeMetersCheckButtonToggled);
+    connect(liveVolumeTrackingCheckButton, &QCheckBox::toggled, this, &MainWindow::onLiveVolumeTrackingToggled);
 
     QAction * quit = new QAction{this};
     connect(quit, &QAction::triggered, this, &MainWindow::doQuit);
     quit->setShortcut(QKeySequence::Quit);
     addAction(quit);
 
+    connect(searchEdit, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
+    QAction * find = new QAction{this};
+    connect(find, &QAction::triggered, this, [this] {
+        searchEdit->setFocus();
+        searchEdit->selectAll();
+    });
+    find->setShortcut(QKeySequence::Find);
+    addAction(find);
+
+    setupSelectionMenu(sinkInputSelectionButton, true);
+    setupSelectionMenu(sourceOutputSelectionButton, false);
+
+    QAction * undo = new QAction{this};
+    connect(undo, &QAction::triggered, this, [] { ChangeHistory::instance()->undo(); });
+    undo->setShortcut(QKeySequence::Undo);
+    addAction(undo);
+
+    QAction * redo = new QAction{this};
+    connect(redo, &QAction::triggered, this, [] { ChangeHistory::instance()->redo(); });
+    redo->setShortcut(QKeySequence::Redo);
+    addAction(redo);
+
+    QMenu *snapshots = new QMenu(snapshotButton);
+    connect(snapshots->addAction(tr("Save Snapshot...")), &QAction::triggered, this, &MainWindow::saveSnapshot);
+    connect(snapshots->addAction(tr("Restore Snapshot...")), &QAction::triggered, this, &MainWindow::restoreSnapshot);
+    snapshotButton->setMenu(snapshots);
+
+    QAction * stats = new QAction{this};
+    connect(stats, &QAction::triggered, this, &MainWindow::showOperationStats);
+    stats->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_D));
+    addAction(stats);
+
     const QSettings config;
 
     showVolumeMetersCheckButton->setChecked(config.value(QStringLiteral("window/showVolumeMeters"), true).toBool());
+    liveVolumeTrackingCheckButton->setChecked(config.value(QStringLiteral("window/liveVolumeTracking"), false).toBool());
 
     const QSize last_size  = config.value(QStringLiteral("window/size")).toSize();
     if (last_size.isValid())
@@ -133,6 +192,7 @@ MainWindow::MainWindow():
 
     /* Hide first and show when we're connected */
     notebook->hide();
+    searchEdit->hide();
     connectingLabel->show();
 #ifdef DEBUG
     idleTimer.start();
@@ -147,6 +207,7 @@ MainWindow::~MainWindow() {
     config.setValue(QStringLiteral("window/sinkType"), sinkTypeComboBox->currentIndex());
     config.setValue(QStringLiteral("window/sourceType"), sourceTypeComboBox->currentIndex());
     config.setValue(QStringLiteral("window/showVolumeMeters"), showVolumeMetersCheckButton->isChecked());
+    config.setValue(QStringLiteral("window/liveVolumeTracking"), liveVolumeTrackingCheckButton->isChecked());
 
     while (!clientNames.empty()) {
         auto i = clientNames.begin();
@@ -169,48 +230,63 @@ void MainWindow::doQuit()
 }
 
 class DeviceWidget;
-static void updatePorts(DeviceWidget *w, std::map<QByteArray, PortInfo> &ports) {
-    std::map<QByteArray, PortInfo>::iterator it;
-    PortInfo p;
+void MainWindow::attachToCard(DeviceWidget *w, uint32_t card) {
+    if (w->card_index == card)
+        return;
+
+    detachFromCard(w);
+    w->card_index = card;
+    if (card != PA_INVALID_INDEX)
+        cardDevices[card].insert(w);
+}
+
+void MainWindow::detachFromCard(DeviceWidget *w) {
+    auto devices = cardDevices.find(w->card_index);
+
+    if (devices == cardDevices.end())
+        return;
+
+    devices->second.erase(w);
+    if (devices->second.empty())
+        cardDevices.erase(devices);
+}
+
+static void updatePorts(DeviceWidget *w, const std::map<QByteArray, PortInfo> &ports) {
+    std::map<QByteArray, PortInfo>::const_iterator it;
 
     for (auto & port : w->ports) {
-        QByteArray desc;
         it = ports.find(port.first);
 
         if (it == ports.end())
             continue;
 
-        p = it->second;
-        desc = p.description;
-
-        if (p.available == PA_PORT_AVAILABLE_YES)
-            desc +=  MainWindow::tr(" (plugged in)").toUtf8().constData();
-        else if (p.available == PA_PORT_AVAILABLE_NO) {
-            if (p.name == "analog-output-speaker" ||
-                p.name == "analog-input-microphone-internal")
-                desc += MainWindow::tr(" (unavailable)").toUtf8().constData();
-            else
-                desc += MainWindow::tr(" (unplugged)").toUtf8().constData();
-        }
-
-        port.second = desc;
+        const PortInfo &p = it->second;
+        port.second = PortLabels::portDescription(p.description, p.available, p.internal);
     }
 
     it = ports.find(w->activePort);
 
-    if (it != ports.end()) {
-        p = it->second;
-        w->setLatencyOffset(p.latency_offset);
+    if (it != ports.end())
+        w->setLatencyOffset(it->second.latency_offset);
+}
+
+/* The fields the search box matches, one per line */
+static QString searchText(std::initializer_list<const char*> fields) {
+    QString text;
+
+    for (const char *f : fields) {
+        if (!f || !*f)
+            continue;
+        if (!text.isEmpty())
+            text += QLatin1Char('\n');
+        text += QString::fromUtf8(f);
     }
+
+    return text;
 }
 
-static void setIconByName(QLabel* label, const char* name, const char* fallback_name = nullptr) {
-    QIcon icon = QIcon::fromTheme(QString::fromLatin1(name));
-    if (icon.isNull() || icon.availableSizes().isEmpty())
-        icon = QIcon::fromTheme(QString::fromLatin1(fallback_name));
-    int size = label->style()->pixelMetric(QStyle::PM_ToolBarIconSize);
-    QPixmap pix = icon.pixmap(size, size);
-    label->setPixmap(pix);
+void MainWindow::setIconByName(QLabel* label, const char* name, const char* fallback_name) {
+    iconCache->setIcon(label, name, fallback_name);
 }
 
 void MainWindow::updateCard(const pa_card_info &info) {
@@ -223,6 +299,7 @@ void MainWindow::updateCard(const pa_card_info &info) {
         w = cardWidgets[info.index];
     else {
         cardWidgets[info.index] = w = new CardWidget(this);
+        Metrics::widgetCreated(Metrics::Card);
         cardsVBox->layout()->addWidget(w);
         w->index = info.index;
         is_new = true;
@@ -234,6 +311,11 @@ void MainWindow::updateCard(const pa_card_info &info) {
     w->name = description ? description : info.name;
     w->nameLabel->setText(QString::fromUtf8(w->name));
 
+    if (searchIndex.set(SearchIndex::Card, info.index,
+                        searchText({w->name.constData(), info.name,
+                                    pa_proplist_gets(info.proplist, PA_PROP_DEVICE_PRODUCT_NAME)})) && !is_new)
+        updateDeviceVisibility();
+
     icon = pa_proplist_gets(info.proplist, PA_PROP_DEVICE_ICON_NAME);
     setIconByName(w->iconImage, icon, "audio-card");
 
@@ -245,7 +327,7 @@ void MainWindow::updateCard(const pa_card_info &info) {
         profile_priorities.insert(*p_profile);
     }
 
-    w->ports.clear();
+    std::map<QByteArray, PortInfo> ports;
     for (uint32_t i = 0; i < info.n_ports; ++i) {
         PortInfo p;
 
@@ -255,36 +337,23 @@ void MainWindow::updateCard(const pa_card_info &info) {
         p.available = info.ports[i]->available;
         p.direction = info.ports[i]->direction;
         p.latency_offset = info.ports[i]->latency_offset;
-        for (pa_card_profile_info2 ** p_profile = info.ports[i]->profiles2; p_profile && *p_profile != nullptr; ++p_profile)
-            p.profiles.push_back((*p_profile)->name);
+        p.internal = PortLabels::isInternalPort(info.ports[i]->name);
 
-        w->ports[p.name] = p;
+        ports[p.name] = p;
     }
 
-    w->profiles.clear();
-    for (auto p_profile : profile_priorities) {
-        bool hasNo = false, hasOther = false;
-        std::map<QByteArray, PortInfo>::iterator portIt;
-        QByteArray desc = p_profile->description;
-
-        for (portIt = w->ports.begin(); portIt != w->ports.end(); portIt++) {
-            PortInfo port = portIt->second;
+    const bool portsChanged = is_new || ports != w->ports;
+    if (portsChanged)
+        w->ports.swap(ports);
 
-            if (std::find(port.profiles.begin(), port.profiles.end(), p_profile->name) == port.profiles.end())
-                continue;
+    /* Which profiles only have unplugged ports */
+    w->profilePorts.build(info);
 
-            if (port.available == PA_PORT_AVAILABLE_NO)
-                hasNo = true;
-            else {
-                hasOther = true;
-                break;
-            }
-        }
-        if (hasNo && !hasOther)
-            desc += tr(" (unplugged)").toUtf8().constData();
-
-        if (!p_profile->available)
-            desc += tr(" (unavailable)").toUtf8().constData();
+    w->profiles.clear();
+    for (auto p_profile : profile_priorities) {
+        const bool unplugged = w->profilePorts.allPortsUnplugged(w->profilePorts.row(p_profile));
+        const QByteArray desc = PortLabels::profileDescription(p_profile->description,
+                                                               unplugged, p_profile->available);
 
         w->profiles.push_back(std::pair<QByteArray,QByteArray>(p_profile->name, desc));
         if (p_profile->n_sinks == 0 && p_profile->n_sources == 0)
@@ -295,30 +364,14 @@ void MainWindow::updateCard(const pa_card_info &info) {
 
     /* Because the port info for sinks and sources is discontinued we need
      * to update the port info for them here. */
-    if (w->hasSinks) {
-        std::map<uint32_t, SinkWidget*>::iterator it;
-
-        for (it = sinkWidgets.begin() ; it != sinkWidgets.end(); it++) {
-            SinkWidget *sw = it->second;
-
-            if (sw->card_index == w->index) {
-                sw->updating = true;
-                updatePorts(sw, w->ports);
-                sw->updating = false;
-            }
-        }
-    }
-
-    if (w->hasSources) {
-        std::map<uint32_t, SourceWidget*>::iterator it;
-
-        for (it = sourceWidgets.begin() ; it != sourceWidgets.end(); it++) {
-            SourceWidget *sw = it->second;
-
-            if (sw->card_index == w->index) {
-                sw->updating = true;
-                updatePorts(sw, w->ports);
-                sw->updating = false;
+    if (portsChanged) {
+        auto devices = cardDevices.find(w->index);
+
+        if (devices != cardDevices.end()) {
+            for (DeviceWidget *dw : devices->second) {
+                dw->updating = true;
+                updatePorts(dw, w->ports);
+                dw->updating = false;
             }
         }
     }
@@ -342,6 +395,7 @@ bool MainWindow::updateSink(const pa_sink_info &info) {
         w = sinkWidgets[info.index];
     else {
         sinkWidgets[info.index] = w = new SinkWidget(this);
+        Metrics::widgetCreated(Metrics::Sink);
         w->setChannelMap(info.channel_map, !!(info.flags & PA_SINK_DECIBEL_VOLUME));
         sinksVBox->layout()->addWidget(w);
         w->index = info.index;
@@ -354,9 +408,15 @@ bool MainWindow::updateSink(const pa_sink_info &info) {
 
     w->updating = true;
 
-    w->card_index = info.card;
+    attachToCard(w, info.card);
     w->name = info.name;
     w->description = info.description;
+    sinkMenu->setDevice(w->index, w->description);
+
+    if (searchIndex.set(SearchIndex::Sink, info.index,
+                        searchText({info.description, info.name,
+                                    pa_proplist_gets(info.proplist, PA_PROP_DEVICE_PRODUCT_NAME)})) && !is_new)
+        updateDeviceVisibility();
     w->type = info.flags & PA_SINK_HARDWARE ? SINK_HARDWARE : SINK_VIRTUAL;
 
     w->boldNameLabel->setText(QLatin1String(""));
@@ -369,6 +429,7 @@ bool MainWindow::updateSink(const pa_sink_info &info) {
     setIconByName(w->iconImage, icon, "audio-card");
 
     w->setVolume(info.volume);
+    volumeGroups->updateMember(w, info.proplist);
     w->muteToggleButton->setChecked(info.mute);
 
     w->setDefault(w->name == defaultSinkName);
@@ -437,6 +498,8 @@ static void read_callback(pa_stream *s, size_t length, void *userdata) {
     assert(length > 0);
     assert(length % sizeof(float) == 0);
 
+    Metrics::meterSampleReceived();
+
     v = ((const float*) data)[length / sizeof(float) -1];
 
     pa_stream_drop(s);
@@ -446,6 +509,9 @@ static void read_callback(pa_stream *s, size_t length, void *userdata) {
     if (v > 1)
         v = 1;
 
+    if (EventTrace::recording())
+        EventTrace::meterSample(pa_stream_get_device_index(s), pa_stream_get_monitor_stream(s), v);
+
     MAINWINDOW_FUNCTION(userdata, updateVolumeMeter(pa_stream_get_device_index(s), pa_stream_get_monitor_stream(s), v));
 }
 
@@ -519,6 +585,7 @@ void MainWindow::updateSource(const pa_source_info &info) {
         w = sourceWidgets[info.index];
     else {
         sourceWidgets[info.index] = w = new SourceWidget(this);
+        Metrics::widgetCreated(Metrics::Source);
         w->setChannelMap(info.channel_map, !!(info.flags & PA_SOURCE_DECIBEL_VOLUME));
         sourcesVBox->layout()->addWidget(w);
 
@@ -534,9 +601,15 @@ void MainWindow::updateSource(const pa_source_info &info) {
 
     w->updating = true;
 
-    w->card_index = info.card;
+    attachToCard(w, info.card);
     w->name = info.name;
     w->description = info.description;
+    sourceMenu->setDevice(w->index, w->description);
+
+    if (searchIndex.set(SearchIndex::Source, info.index,
+                        searchText({info.description, info.name,
+                                    pa_proplist_gets(info.proplist, PA_PROP_DEVICE_PRODUCT_NAME)})) && !is_new)
+        updateDeviceVisibility();
     w->type = info.monitor_of_sink != PA_INVALID_INDEX ? SOURCE_MONITOR : (info.flags & PA_SOURCE_HARDWARE ? SOURCE_HARDWARE : SOURCE_VIRTUAL);
 
     w->boldNameLabel->setText(QLatin1String(""));
@@ -549,6 +622,7 @@ void MainWindow::updateSource(const pa_source_info &info) {
     setIconByName(w->iconImage, icon, "audio-input-microphone");
 
     w->setVolume(info.volume);
+    volumeGroups->updateMember(w, info.proplist);
     w->muteToggleButton->setChecked(info.mute);
 
     w->setDefault(w->name == defaultSourceName);
@@ -640,6 +714,7 @@ void MainWindow::updateSinkInput(const pa_sink_input_info &info) {
                 createMonitorStreamForSinkInput(w, info.sink);
     } else {
         sinkInputWidgets[info.index] = w = new SinkInputWidget(this);
+        Metrics::widgetCreated(Metrics::SinkInput);
         w->setChannelMap(info.channel_map, true);
         streamsVBox->layout()->addWidget(w);
 
@@ -657,6 +732,7 @@ void MainWindow::updateSinkInput(const pa_sink_input_info &info) {
     w->type = info.client != PA_INVALID_INDEX ? SINK_INPUT_CLIENT : SINK_INPUT_VIRTUAL;
 
     w->setSinkIndex(info.sink);
+    w->streamKey = MixerSnapshot::streamKey(info.proplist);
 
     char *txt;
     if (clientNames.count(info.client)) {
@@ -671,9 +747,19 @@ void MainWindow::updateSinkInput(const pa_sink_input_info &info) {
 
     w->nameLabel->setToolTip(QString::fromUtf8(info.name));
 
+    if (searchIndex.set(SearchIndex::SinkInput, info.index,
+                        searchText({info.name,
+                                    pa_proplist_gets(info.proplist, PA_PROP_APPLICATION_NAME),
+                                    pa_proplist_gets(info.proplist, PA_PROP_APPLICATION_PROCESS_BINARY),
+                                    pa_proplist_gets(info.proplist, PA_PROP_MEDIA_NAME),
+                                    pa_proplist_gets(info.proplist, PA_PROP_MEDIA_ROLE)}),
+                        info.client) && !is_new)
+        updateDeviceVisibility();
+
     setIconFromProplist(w->iconImage, info.proplist, "audio-card");
 
     w->setVolume(info.volume);
+    volumeGroups->updateMember(w, info.proplist);
     w->muteToggleButton->setChecked(info.mute);
 
     w->updating = false;
@@ -697,6 +783,7 @@ void MainWindow::updateSourceOutput(const pa_source_output_info &info) {
         w = sourceOutputWidgets[info.index];
     else {
         sourceOutputWidgets[info.index] = w = new SourceOutputWidget(this);
+        Metrics::widgetCreated(Metrics::SourceOutput);
 #if HAVE_SOURCE_OUTPUT_VOLUMES
         w->setChannelMap(info.channel_map, true);
 #endif
@@ -713,6 +800,7 @@ void MainWindow::updateSourceOutput(const pa_source_output_info &info) {
     w->type = info.client != PA_INVALID_INDEX ? SOURCE_OUTPUT_CLIENT : SOURCE_OUTPUT_VIRTUAL;
 
     w->setSourceIndex(info.source);
+    w->streamKey = MixerSnapshot::streamKey(info.proplist);
 
     char *txt;
     if (clientNames.count(info.client)) {
@@ -727,10 +815,20 @@ void MainWindow::updateSourceOutput(const pa_source_output_info &info) {
 
     w->nameLabel->setToolTip(QString::fromUtf8(info.name));
 
+    if (searchIndex.set(SearchIndex::SourceOutput, info.index,
+                        searchText({info.name,
+                                    pa_proplist_gets(info.proplist, PA_PROP_APPLICATION_NAME),
+                                    pa_proplist_gets(info.proplist, PA_PROP_APPLICATION_PROCESS_BINARY),
+                                    pa_proplist_gets(info.proplist, PA_PROP_MEDIA_NAME),
+                                    pa_proplist_gets(info.proplist, PA_PROP_MEDIA_ROLE)}),
+                        info.client) && !is_new)
+        updateDeviceVisibility();
+
     setIconFromProplist(w->iconImage, info.proplist, "audio-input-microphone");
 
 #if HAVE_SOURCE_OUTPUT_VOLUMES
     w->setVolume(info.volume);
+    volumeGroups->updateMember(w, info.proplist);
     w->muteToggleButton->setChecked(info.mute);
 #endif
 
@@ -744,6 +842,9 @@ void MainWindow::updateClient(const pa_client_info &info) {
     g_free(clientNames[info.index]);
     clientNames[info.index] = g_strdup(info.name);
 
+    if (searchIndex.setClientName(info.index, QString::fromUtf8(info.name)))
+        updateDeviceVisibility();
+
     for (auto & sinkInputWidget : sinkInputWidgets) {
         SinkInputWidget *w = sinkInputWidget.second;
 
@@ -930,9 +1031,11 @@ void MainWindow::setConnectionState(gboolean connected) {
         m_connected = connected;
         if (m_connected) {
             connectingLabel->hide();
+            searchEdit->show();
             notebook->show();
         } else {
             notebook->hide();
+            searchEdit->hide();
             connectingLabel->show();
         }
     }
@@ -988,7 +1091,8 @@ void MainWindow::reallyUpdateDeviceVisibility() {
             w->deviceButton->hide();
         }
 
-        if (showSinkInputType == SINK_INPUT_ALL || w->type == showSinkInputType) {
+        if ((showSinkInputType == SINK_INPUT_ALL || w->type == showSinkInputType)
+            && searchIndex.matches(SearchIndex::SinkInput, w->index)) {
             w->show();
             is_empty = false;
         } else
@@ -1016,7 +1120,8 @@ void MainWindow::reallyUpdateDeviceVisibility() {
             w->deviceButton->hide();
         }
 
-        if (showSourceOutputType == SOURCE_OUTPUT_ALL || w->type == showSourceOutputType) {
+        if ((showSourceOutputType == SOURCE_OUTPUT_ALL || w->type == showSourceOutputType)
+            && searchIndex.matches(SearchIndex::SourceOutput, w->index)) {
             w->show();
             is_empty = false;
         } else
@@ -1033,7 +1138,8 @@ void MainWindow::reallyUpdateDeviceVisibility() {
     for (auto & sinkWidget : sinkWidgets) {
         SinkWidget* w = sinkWidget.second;
 
-        if (showSinkType == SINK_ALL || w->type == showSinkType) {
+        if ((showSinkType == SINK_ALL || w->type == showSinkType)
+            && searchIndex.matches(SearchIndex::Sink, w->index)) {
             w->show();
             is_empty = false;
         } else
@@ -1050,8 +1156,11 @@ void MainWindow::reallyUpdateDeviceVisibility() {
     for (auto & cardWidget : cardWidgets) {
         CardWidget* w = cardWidget.second;
 
-        w->show();
-        is_empty = false;
+        if (searchIndex.matches(SearchIndex::Card, w->index)) {
+            w->show();
+            is_empty = false;
+        } else
+            w->hide();
     }
 
     if (is_empty)
@@ -1064,9 +1173,10 @@ void MainWindow::reallyUpdateDeviceVisibility() {
     for (auto & sourceWidget : sourceWidgets) {
         SourceWidget* w = sourceWidget.second;
 
-        if (showSourceType == SOURCE_ALL ||
-            w->type == showSourceType ||
-            (showSourceType == SOURCE_NO_MONITOR && w->type != SOURCE_MONITOR)) {
+        if ((showSourceType == SOURCE_ALL ||
+             w->type == showSourceType ||
+             (showSourceType == SOURCE_NO_MONITOR && w->type != SOURCE_MONITOR))
+            && searchIndex.matches(SearchIndex::Source, w->index)) {
             w->show();
             is_empty = false;
         } else
@@ -1096,7 +1206,9 @@ void MainWindow::removeCard(uint32_t index) {
     if (!cardWidgets.count(index))
         return;
 
+    searchIndex.remove(SearchIndex::Card, index);
     delete cardWidgets[index];
+    Metrics::widgetsDestroyed(Metrics::Card);
     cardWidgets.erase(index);
     updateDeviceVisibility();
 }
@@ -1105,7 +1217,13 @@ void MainWindow::removeSink(uint32_t index) {
     if (!sinkWidgets.count(index))
         return;
 
+    detachFromCard(sinkWidgets[index]);
+    sinkMenu->removeDevice(index);
+    searchIndex.remove(SearchIndex::Sink, index);
+    volumeGroups->removeMember(sinkWidgets[index]);
+    sinkWidgets[index]->cancelFade();
     delete sinkWidgets[index];
+    Metrics::widgetsDestroyed(Metrics::Sink);
     sinkWidgets.erase(index);
     updateDeviceVisibility();
 }
@@ -1114,7 +1232,13 @@ void MainWindow::removeSource(uint32_t index) {
     if (!sourceWidgets.count(index))
         return;
 
+    detachFromCard(sourceWidgets[index]);
+    sourceMenu->removeDevice(index);
+    searchIndex.remove(SearchIndex::Source, index);
+    volumeGroups->removeMember(sourceWidgets[index]);
+    sourceWidgets[index]->cancelFade();
     delete sourceWidgets[index];
+    Metrics::widgetsDestroyed(Metrics::Source);
     sourceWidgets.erase(index);
     updateDeviceVisibility();
 }
@@ -1123,7 +1247,11 @@ void MainWindow::removeSinkInput(uint32_t index) {
     if (!sinkInputWidgets.count(index))
         return;
 
+    searchIndex.remove(SearchIndex::SinkInput, index);
+    volumeGroups->removeMember(sinkInputWidgets[index]);
+    sinkInputWidgets[index]->cancelFade();
     delete sinkInputWidgets[index];
+    Metrics::widgetsDestroyed(Metrics::SinkInput);
     sinkInputWidgets.erase(index);
     updateDeviceVisibility();
 }
@@ -1132,7 +1260,11 @@ void MainWindow::removeSourceOutput(uint32_t index) {
     if (!sourceOutputWidgets.count(index))
         return;
 
+    searchIndex.remove(SearchIndex::SourceOutput, index);
+    volumeGroups->removeMember(sourceOutputWidgets[index]);
+    sourceOutputWidgets[index]->cancelFade();
     delete sourceOutputWidgets[index];
+    Metrics::widgetsDestroyed(Metrics::SourceOutput);
     sourceOutputWidgets.erase(index);
     updateDeviceVisibility();
 }
@@ -1140,24 +1272,36 @@ void MainWindow::removeSourceOutput(uint32_t index) {
 void MainWindow::removeClient(uint32_t index) {
     g_free(clientNames[index]);
     clientNames.erase(index);
+    searchIndex.removeClient(index);
 }
 
 void MainWindow::removeAllWidgets() {
+    FadeScheduler::instance()->cancelAll();
+    Metrics::widgetsDestroyed(Metrics::SinkInput, sinkInputWidgets.size());
     for (auto & sinkInputWidget : sinkInputWidgets)
         delete sinkInputWidget.second;
     sinkInputWidgets.clear();
+    Metrics::widgetsDestroyed(Metrics::SourceOutput, sourceOutputWidgets.size());
     for (auto & sourceOutputWidget : sourceOutputWidgets)
         delete sourceOutputWidget.second;
     sourceOutputWidgets.clear();
+    Metrics::widgetsDestroyed(Metrics::Sink, sinkWidgets.size());
     for (auto & sinkWidget : sinkWidgets)
         delete sinkWidget.second;
     sinkWidgets.clear();
+    Metrics::widgetsDestroyed(Metrics::Source, sourceWidgets.size());
     for (auto & sourceWidget : sourceWidgets)
         delete sourceWidget.second;
     sourceWidgets.clear();
+    Metrics::widgetsDestroyed(Metrics::Card, cardWidgets.size());
     for (auto & cardWidget : cardWidgets)
         delete cardWidget.second;
     cardWidgets.clear();
+    cardDevices.clear();
+    sinkMenu->clearDevices();
+    sourceMenu->clearDevices();
+    searchIndex.clear();
+    volumeGroups->clearMembers();
     for (auto & clientName : clientNames) {
         g_free(clientName.second);
     }
@@ -1253,3 +1397,245 @@ void MainWindow::onShowVolumeMetersCheckButtonToggled(bool /*toggled*/) {
         sw->setVolumeMeterVisible(state);
     }
 }
+
+void MainWindow::onLiveVolumeTrackingToggled(bool toggled) {
+    MinimalStreamWidget::setLiveVolumeTracking(toggled);
+
+    for (auto & sinkWidget : sinkWidgets)
+        sinkWidget.second->setVolumeTracking(toggled);
+    for (auto & sourceWidget : sourceWidgets)
+        sourceWidget.second->setVolumeTracking(toggled);
+    for (auto & sinkInputWidget : sinkInputWidgets)
+        sinkInputWidget.second->setVolumeTracking(toggled);
+    for (auto & sourceOutputWidget : sourceOutputWidgets)
+        sourceOutputWidget.second->setVolumeTracking(toggled);
+    if (eventRoleWidget)
+        eventRoleWidget->setVolumeTracking(toggled);
+}
+
+void MainWindow::showOperationStats() {
+    if (!operationStatsDialog)
+        operationStatsDialog = new OperationStatsDialog(this);
+
+    operationStatsDialog->show();
+    operationStatsDialog->raise();
+    operationStatsDialog->activateWindow();
+}
+
+void MainWindow::setupSelectionMenu(QToolButton *button, bool playback) {
+    QMenu *menu = new QMenu(button);
+
+    connect(menu->addAction(tr("Select All")), &QAction::triggered, this, [this, playback] {
+        setStreamsSelected(playback, true);
+    });
+    connect(menu->addAction(tr("Clear Selection")), &QAction::triggered, this, [this, playback] {
+        setStreamsSelected(playback, false);
+    });
+    menu->addSeparator();
+
+    QAction *mute = menu->addAction(tr("Mute"));
+    connect(mute, &QAction::triggered, this, [this, playback] { bulkSetMute(playback, true); });
+    QAction *unmute = menu->addAction(tr("Unmute"));
+    connect(unmute, &QAction::triggered, this, [this, playback] { bulkSetMute(playback, false); });
+    QAction *volume = menu->addAction(tr("Set Volume..."));
+    connect(volume, &QAction::triggered, this, [this, playback] { bulkSetVolume(playback); });
+
+    QMenu *move = menu->addMenu(tr("Move To"));
+    connect(move, &QMenu::aboutToShow, this, [this, move, playback] {
+        move->clear();
+        if (playback) {
+            for (const auto &it : sinkWidgets) {
+                const uint32_t device = it.first;
+                connect(move->addAction(QString::fromUtf8(it.second->description)), &QAction::triggered,
+                        this, [this, device] { bulkMove(true, device); });
+            }
+        } else {
+            for (const auto &it : sourceWidgets) {
+                const uint32_t device = it.first;
+                connect(move->addAction(QString::fromUtf8(it.second->description)), &QAction::triggered,
+                        this, [this, device] { bulkMove(false, device); });
+            }
+        }
+    });
+
+    connect(menu, &QMenu::aboutToShow, this, [=] {
+        const bool any = !selectedStreams(playback).empty();
+        mute->setEnabled(any);
+        unmute->setEnabled(any);
+        volume->setEnabled(any);
+        move->setEnabled(any);
+    });
+
+    button->setMenu(menu);
+}
+
+/* Streams hidden by the type filter or the search box are left alone */
+std::vector<StreamWidget*> MainWindow::selectedStreams(bool playback) const {
+    std::vector<StreamWidget*> streams;
+
+    if (playback) {
+        for (const auto &it : sinkInputWidgets) {
+            if (it.second->isSelected() && !it.second->isHidden())
+                streams.push_back(it.second);
+        }
+    } else {
+        for (const auto &it : sourceOutputWidgets) {
+            if (it.second->isSelected() && !it.second->isHidden())
+                streams.push_back(it.second);
+        }
+    }
+
+    return streams;
+}
+
+void MainWindow::setStreamsSelected(bool playback, bool selected) {
+    if (playback) {
+        for (const auto &it : sinkInputWidgets)
+            it.second->setSelected(selected && !it.second->isHidden());
+    } else {
+        for (const auto &it : sourceOutputWidgets)
+            it.second->setSelected(selected && !it.second->isHidden());
+    }
+}
+
+/* The bulk actions issue all their operations before returning to the
+ * mainloop, so that they reach the server in one go, and report once. */
+void MainWindow::bulkSetMute(bool playback, bool mute) {
+    const std::vector<StreamWidget*> streams = selectedStreams(playback);
+    OperationBatch *batch = new OperationBatch(this);
+
+    for (StreamWidget *w : streams) {
+        /* leave the streams already there out of the request and of the history */
+        if (w->muteToggleButton->isChecked() == mute)
+            continue;
+
+        w->recordMute(!mute, mute);
+        w->updating = true;
+        w->muteToggleButton->setChecked(mute);
+        w->updating = false;
+        batch->add(w->muteOperation(mute, batch->callback(), batch->userdata()));
+    }
+
+    reportBatch(batch, playback, mute ? tr("Mute") : tr("Unmute"));
+}
+
+void MainWindow::bulkSetVolume(bool playback) {
+    bool ok;
+    const int percent = QInputDialog::getInt(this, tr("Set Volume"), tr("Volume of the selected streams (%):"),
+                                             100, 0, 153, 1, &ok);
+    if (!ok)
+        return;
+
+    const pa_volume_t v = (pa_volume_t) ((double) PA_VOLUME_NORM * percent / 100.0);
+    const std::vector<StreamWidget*> streams = selectedStreams(playback);
+    OperationBatch *batch = new OperationBatch(this);
+
+    for (StreamWidget *w : streams) {
+        pa_cvolume volume = w->volume;
+        pa_cvolume_set(&volume, volume.channels, v);
+        w->recordVolume(w->volume, volume);
+        w->setVolume(volume, true);
+        batch->add(w->sendVolumeUpdate(batch->callback(), batch->userdata()));
+    }
+
+    reportBatch(batch, playback, tr("Set Volume"));
+}
+
+void MainWindow::bulkMove(bool playback, uint32_t device) {
+    const std::vector<StreamWidget*> streams = selectedStreams(playback);
+    OperationBatch *batch = new OperationBatch(this);
+
+    for (StreamWidget *w : streams)
+        batch->add(w->moveOperation(device, batch->callback(), batch->userdata()));
+
+    reportBatch(batch, playback, tr("Move"));
+}
+
+void MainWindow::reportBatch(OperationBatch *batch, bool playback, const QString &action) {
+    QToolButton *button = playback ? sinkInputSelectionButton : sourceOutputSelectionButton;
+
+    connect(batch, &OperationBatch::finished, button, [button, action](int succeeded, int failed, int lost, qint64 elapsedMs) {
+        QString text = tr("%1: %2 of %3 streams done in %4 ms").arg(action).arg(succeeded).arg(succeeded + failed + lost).arg(elapsedMs);
+        if (failed)
+            text += QLatin1Char('\n') + tr("%n failed", nullptr, failed);
+        if (lost)
+            text += QLatin1Char('\n') + tr("%n did not complete", nullptr, lost);
+        QToolTip::showText(button->mapToGlobal(QPoint(0, button->height())), text, button);
+    });
+
+    batch->commit();
+}
+
+static QString snapshotDirectory() {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/snapshots");
+    QDir().mkpath(dir);
+    return dir;
+}
+
+void MainWindow::saveSnapshot() {
+    const QString file = QFileDialog::getSaveFileName(this, tr("Save Snapshot"), snapshotDirectory(),
+                                                      tr("Mixer snapshots (*.json)"));
+    if (file.isEmpty())
+        return;
+
+    QFile f(file);
+    if (!f.open(QIODevice::WriteOnly) || f.write(MixerSnapshot::capture(this)) < 0)
+        QMessageBox::warning(this, tr("Error"), tr("Could not save the snapshot: %1").arg(f.errorString()));
+}
+
+void MainWindow::restoreSnapshot() {
+    const QString file = QFileDialog::getOpenFileName(this, tr("Restore Snapshot"), snapshotDirectory(),
+                                                      tr("Mixer snapshots (*.json)"));
+    if (file.isEmpty())
+        return;
+
+    QFile f(file);
+    QString error;
+    if (!f.open(QIODevice::ReadOnly))
+        error = f.errorString();
+    else
+        applySnapshot(f.readAll(), &error);
+
+    if (!error.isEmpty())
+        QMessageBox::warning(this, tr("Error"), tr("Could not restore the snapshot: %1").arg(error));
+}
+
+bool MainWindow::applySnapshot(const QByteArray &data, QString *error) {
+    OperationBatch *batch = new OperationBatch(this);
+
+    if (!MixerSnapshot::restore(this, data, batch, error)) {
+        delete batch;
+        return false;
+    }
+
+    QToolButton *button = snapshotButton;
+    connect(batch, &OperationBatch::finished, button, [button](int succeeded, int failed, int lost, qint64 elapsedMs) {
+        QString text;
+        if (succeeded + failed + lost == 0)
+            text = tr("The mixer already matches the snapshot");
+        else
+            text = tr("Snapshot restored: %1 of %2 changes applied in %3 ms").arg(succeeded).arg(succeeded + failed + lost).arg(elapsedMs);
+        QToolTip::showText(button->mapToGlobal(QPoint(0, button->height())), text, button);
+    });
+    batch->commit();
+
+    return true;
+}
+
+void MainWindow::selectTab(int tab) {
+    if (tab >= 1 && tab <= notebook->count())
+        notebook->setCurrentIndex(tab - 1);
+    else if (!sinkInputWidgets.empty())
+        notebook->setCurrentIndex(0);
+    else if (!sourceOutputWidgets.empty())
+        notebook->setCurrentIndex(1);
+    else if (!sourceWidgets.empty() && sinkWidgets.empty())
+        notebook->setCurrentIndex(3);
+    else
+        notebook->setCurrentIndex(2);
+}
+
+void MainWindow::onSearchTextChanged(const QString &text) {
+    searchIndex.setQuery(text);
+    updateDeviceVisibility();
+}
@@ -23,19 +23,30 @@
 
 #include "pavucontrol.h"
 #include <pulse/ext-stream-restore.h>
+#include <map>
+#include <set>
+#include <vector>
 #if HAVE_EXT_DEVICE_RESTORE_API
 #  include <pulse/ext-device-restore.h>
 #endif
 
 #include <QDialog>
 #include "ui_mainwindow.h"
+#include "searchindex.h"
 
 class CardWidget;
+class DeviceWidget;
 class SinkWidget;
+class StreamWidget;
 class SourceWidget;
 class SinkInputWidget;
 class SourceOutputWidget;
 class RoleWidget;
+class IconCache;
+class DeviceMenu;
+class OperationStatsDialog;
+class OperationBatch;
+class VolumeGroups;
 
 class MainWindow : public QDialog, public Ui::MainWindow {
     Q_OBJECT
@@ -73,6 +84,9 @@ public:
     std::map<uint32_t, SinkInputWidget*> sinkInputWidgets;
     std::map<uint32_t, SourceOutputWidget*> sourceOutputWidgets;
 
+    // the move-to-device menus shared by all stream widgets
+    DeviceMenu *sinkMenu, *sourceMenu;
+
     std::map<uint32_t, char*> clientNames;
     SinkInputType showSinkInputType;
     SinkType showSinkType;
@@ -85,6 +99,11 @@ protected Q_SLOTS:
     virtual void onSinkTypeComboBoxChanged(int index);
     virtual void onSourceTypeComboBoxChanged(int index);
     virtual void onShowVolumeMetersCheckButtonToggled(bool toggled);
+    void onSearchTextChanged(const QString &text);
+    void onLiveVolumeTrackingToggled(bool toggled);
+    void showOperationStats();
+    void saveSnapshot();
+    void restoreSnapshot();
     void doQuit();
 
 public:
@@ -95,6 +114,7 @@ public:
     void createMonitorStreamForSinkInput(SinkInputWidget* w, uint32_t sink_idx);
 
     void setIconFromProplist(QLabel *icon, pa_proplist *l, const char *name);
+    void setIconByName(QLabel *label, const char *name, const char *fallback_name = nullptr);
 
     RoleWidget *eventRoleWidget;
 
@@ -105,9 +125,36 @@ public:
 
     bool canRenameDevices;
 
+    // applies a MixerSnapshot; false, with a message in error, if it is not one
+    bool applySnapshot(const QByteArray &data, QString *error);
+
+    // shows tab (1-based, as given to --tab); any other value picks a tab that isn't empty
+    void selectTab(int tab);
+
 private:
+    // the Selection menus of the Playback (playback) and Recording tabs
+    void setupSelectionMenu(QToolButton *button, bool playback);
+    std::vector<StreamWidget*> selectedStreams(bool playback) const;
+    void setStreamsSelected(bool playback, bool selected);
+    void bulkSetMute(bool playback, bool mute);
+    void bulkSetVolume(bool playback);
+    void bulkMove(bool playback, uint32_t device);
+    void reportBatch(OperationBatch *batch, bool playback, const QString &action);
+
+    void attachToCard(DeviceWidget *w, uint32_t card);
+    void detachFromCard(DeviceWidget *w);
+
+    // the sinks and sources of each card, which need their port
+    // descriptions refreshed whenever the card's port table changes
+    std::map<uint32_t, std::set<DeviceWidget*> > cardDevices;
+
+    SearchIndex searchIndex;
+
     gboolean m_connected;
     gchar* m_config_filename;
+    IconCache *iconCache;
+    OperationStatsDialog *operationStatsDialog;
+    VolumeGroups *volumeGroups;
 };
 
 #ifdef USE_THREADED_PALOOP
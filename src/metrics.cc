@@ -0,0 +1,159 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "metrics.h"
+#include "operationstats.h"
+
+std::atomic<uint64_t> Metrics::subscriptionEvents[Metrics::FacilityCount];
+std::atomic<uint64_t> Metrics::infoQueries[Metrics::FacilityCount];
+std::atomic<uint64_t> Metrics::infoQueriesCoalescable[Metrics::FacilityCount];
+std::atomic<uint64_t> Metrics::meterSamplesReceived;
+std::atomic<uint64_t> Metrics::meterSamplesRendered;
+std::atomic<uint64_t> Metrics::widgetsCreated[Metrics::WidgetKindCount];
+std::atomic<uint64_t> Metrics::widgetsDestroyedCount[Metrics::WidgetKindCount];
+std::atomic<uint64_t> Metrics::guiStalls;
+std::atomic<uint64_t> Metrics::guiStallUs;
+
+/* indexed by facility; the ones we do not subscribe to stay at zero and are left out */
+static const char *const facilityNames[Metrics::FacilityCount] = {
+    "sink",
+    "source",
+    "sink-input",
+    "source-output",
+    nullptr,
+    "client",
+    nullptr,
+    "server",
+    nullptr,
+    "card",
+};
+
+static const char *const widgetKindNames[Metrics::WidgetKindCount] = {
+    "card",
+    "sink",
+    "source",
+    "sink-input",
+    "source-output",
+};
+
+void Metrics::guiStall(uint64_t us) {
+    guiStalls.fetch_add(1, std::memory_order_relaxed);
+    guiStallUs.fetch_add(us, std::memory_order_relaxed);
+}
+
+static void header(QByteArray &out, const char *name, const char *type, const char *help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+static void sample(QByteArray &out, const char *name, const QByteArray &labels, uint64_t value) {
+    out += name;
+    if (!labels.isEmpty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += QByteArray::number((qulonglong) value);
+    out += '\n';
+}
+
+static void sample(QByteArray &out, const char *name, const QByteArray &labels, double value) {
+    out += name;
+    if (!labels.isEmpty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += QByteArray::number(value, 'g', 10);
+    out += '\n';
+}
+
+static void perFacility(QByteArray &out, const char *name, const char *help, const std::atomic<uint64_t> *counters) {
+    header(out, name, "counter", help);
+    for (int f = 0; f < Metrics::FacilityCount; f++) {
+        if (facilityNames[f])
+            sample(out, name, QByteArray("facility=\"" + QByteArray(facilityNames[f]) + '"'), counters[f].load(std::memory_order_relaxed));
+    }
+}
+
+static void perWidgetKind(QByteArray &out, const char *name, const char *help, const std::atomic<uint64_t> *counters) {
+    header(out, name, "counter", help);
+    for (int k = 0; k < Metrics::WidgetKindCount; k++)
+        sample(out, name, QByteArray("kind=\"" + QByteArray(widgetKindNames[k]) + '"'), counters[k].load(std::memory_order_relaxed));
+}
+
+QByteArray Metrics::toPrometheus() {
+    QByteArray out;
+    out.reserve(8192);
+
+    perFacility(out, "pavucontrol_subscription_events_total", "Subscription events received from the server.", subscriptionEvents);
+    perFacility(out, "pavucontrol_info_queries_total", "Info queries issued for subscription events.", infoQueries);
+    perFacility(out, "pavucontrol_info_queries_coalescable_total", "Info queries issued while one for the same object was still running.", infoQueriesCoalescable);
+
+    header(out, "pavucontrol_meter_samples_received_total", "counter", "Peak meter samples received.");
+    sample(out, "pavucontrol_meter_samples_received_total", QByteArray(), meterSamplesReceived.load(std::memory_order_relaxed));
+    header(out, "pavucontrol_meter_samples_rendered_total", "counter", "Peak meter samples that changed a meter.");
+    sample(out, "pavucontrol_meter_samples_rendered_total", QByteArray(), meterSamplesRendered.load(std::memory_order_relaxed));
+
+    perWidgetKind(out, "pavucontrol_widgets_created_total", "Widgets created.", widgetsCreated);
+    perWidgetKind(out, "pavucontrol_widgets_destroyed_total", "Widgets destroyed.", widgetsDestroyedCount);
+
+    header(out, "pavucontrol_gui_stalls_total", "counter", "Times the GUI event loop was late.");
+    sample(out, "pavucontrol_gui_stalls_total", QByteArray(), guiStalls.load(std::memory_order_relaxed));
+    header(out, "pavucontrol_gui_stall_seconds_total", "counter", "Time the GUI event loop was late by.");
+    sample(out, "pavucontrol_gui_stall_seconds_total", QByteArray(), guiStallUs.load(std::memory_order_relaxed) / 1e6);
+
+    /* the OperationStats buckets are per interval; Prometheus wants them cumulative */
+    const char *const ops = "pavucontrol_operation_duration_seconds";
+    header(out, ops, "histogram", "Time from issuing a control operation to its completion.");
+    for (int k = 0; k < OperationStats::KindCount; k++) {
+        const OperationStats::Snapshot s = OperationStats::snapshot(static_cast<OperationStats::Kind>(k));
+        const QByteArray kind = "operation=\"" + QByteArray(OperationStats::kindName(static_cast<OperationStats::Kind>(k))) + '"';
+
+        uint64_t count = 0;
+        for (int b = 0; b < OperationStats::BucketCount; b++) {
+            count += s.buckets[b];
+            const QByteArray le = b < OperationStats::BucketCount - 1
+                ? QByteArray::number(OperationStats::bucketLimitUs(b) / 1e6, 'g', 10)
+                : QByteArray("+Inf");
+            sample(out, "pavucontrol_operation_duration_seconds_bucket", QByteArray(kind + ",le=\"" + le + '"'), count);
+        }
+        sample(out, "pavucontrol_operation_duration_seconds_sum", kind, s.totalUs / 1e6);
+        sample(out, "pavucontrol_operation_duration_seconds_count", kind, count);
+    }
+
+    header(out, "pavucontrol_operations_failed_total", "counter", "Control operations that failed or could not be issued.");
+    for (int k = 0; k < OperationStats::KindCount; k++) {
+        const QByteArray kind = "operation=\"" + QByteArray(OperationStats::kindName(static_cast<OperationStats::Kind>(k))) + '"';
+        sample(out, "pavucontrol_operations_failed_total", kind, OperationStats::snapshot(static_cast<OperationStats::Kind>(k)).failed);
+    }
+
+    return out;
+}
@@ -0,0 +1,79 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef metrics_h
+#define metrics_h
+
+#include <pulse/pulseaudio.h>
+#include <QByteArray>
+#include <atomic>
+#include <stdint.h>
+
+// Internal counters, updated from the mainloop callbacks and the window
+// and rendered in the Prometheus text format together with the
+// OperationStats histograms; see MetricsExporter for how they get out.
+// Every update is a single relaxed atomic increment, so they are always on.
+class Metrics {
+public:
+    enum WidgetKind {
+        Card,
+        Sink,
+        Source,
+        SinkInput,
+        SourceOutput,
+        WidgetKindCount
+    };
+
+    /* the PA_SUBSCRIPTION_EVENT_* facilities */
+    static constexpr int FacilityCount = PA_SUBSCRIPTION_EVENT_CARD + 1;
+
+    static void subscriptionEvent(int facility) { add(subscriptionEvents, facility); }
+    static void infoQueryIssued(int facility) { add(infoQueries, facility); }
+    // an event that came while the query for an earlier one on the same object
+    // was still running, so one query could have served both; see subscribe_cb()
+    static void infoQueryCoalescable(int facility) { add(infoQueriesCoalescable, facility); }
+
+    static void meterSampleReceived() { meterSamplesReceived.fetch_add(1, std::memory_order_relaxed); }
+    // a sample that changed what a peak meter shows
+    static void meterSampleRendered() { meterSamplesRendered.fetch_add(1, std::memory_order_relaxed); }
+
+    static void widgetCreated(WidgetKind kind) { widgetsCreated[kind].fetch_add(1, std::memory_order_relaxed); }
+    static void widgetsDestroyed(WidgetKind kind, uint64_t n = 1) { widgetsDestroyedCount[kind].fetch_add(n, std::memory_order_relaxed); }
+
+    // the GUI event loop was late by this long
+    static void guiStall(uint64_t us);
+
+    static QByteArray toPrometheus();
+
+private:
+    static void add(std::atomic<uint64_t> *counters, int facility) {
+        if (facility >= 0 && facility < FacilityCount)
+            counters[facility].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static std::atomic<uint64_t> subscriptionEvents[FacilityCount];
+    static std::atomic<uint64_t> infoQueries[FacilityCount];
+    static std::atomic<uint64_t> infoQueriesCoalescable[FacilityCount];
+    static std::atomic<uint64_t> meterSamplesReceived;
+    static std::atomic<uint64_t> meterSamplesRendered;
+    static std::atomic<uint64_t> widgetsCreated[WidgetKindCount];
+    static std::atomic<uint64_t> widgetsDestroyedCount[WidgetKindCount];
+    static std::atomic<uint64_t> guiStalls;
+    static std::atomic<uint64_t> guiStallUs;
+};
+
+#endif
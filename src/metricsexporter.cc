@@ -0,0 +1,95 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "metricsexporter.h"
+#include "metrics.h"
+#include <QLocalSocket>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+
+#define DEFAULT_FILE_INTERVAL 15
+/* the heartbeat period, and how late it has to be to count as a stall, in ms */
+#define HEARTBEAT_INTERVAL 250
+#define STALL_THRESHOLD 50
+
+MetricsExporter::MetricsExporter(QObject *parent) :
+    QObject(parent) {
+
+    const QSettings config;
+    bool enabled = false;
+
+    if (config.value(QStringLiteral("metrics/socket"), false).toBool()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+        const QString path = dir + QStringLiteral("/pavucontrol-qt.metrics");
+
+        mServer.setSocketOptions(QLocalServer::UserAccessOption);
+        connect(&mServer, &QLocalServer::newConnection, this, &MetricsExporter::onNewConnection);
+        /* no client can tell the metrics of two instances apart: the latest one wins */
+        QLocalServer::removeServer(path);
+        if (!dir.isEmpty() && mServer.listen(path))
+            enabled = true;
+        else
+            qWarning("%s", tr("Cannot listen on %1: %2").arg(path, mServer.errorString()).toUtf8().constData());
+    }
+
+    mFile = config.value(QStringLiteral("metrics/file")).toString();
+    if (!mFile.isEmpty()) {
+        const int interval = config.value(QStringLiteral("metrics/interval"), DEFAULT_FILE_INTERVAL).toInt();
+        connect(&mFileTimer, &QTimer::timeout, this, &MetricsExporter::writeFile);
+        mFileTimer.start(qMax(1, interval) * 1000);
+        enabled = true;
+    }
+
+    if (enabled) {
+        connect(&mHeartbeat, &QTimer::timeout, this, &MetricsExporter::heartbeat);
+        mHeartbeat.setTimerType(Qt::PreciseTimer);
+        mHeartbeat.start(HEARTBEAT_INTERVAL);
+        mSinceHeartbeat.start();
+    }
+}
+
+MetricsExporter::~MetricsExporter() {
+    mServer.close();
+}
+
+void MetricsExporter::onNewConnection() {
+    while (QLocalSocket *socket = mServer.nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        socket->write(Metrics::toPrometheus());
+        socket->disconnectFromServer();
+    }
+}
+
+void MetricsExporter::writeFile() {
+    /* collectors must never see a partial file */
+    QSaveFile file(mFile);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    file.write(Metrics::toPrometheus());
+    file.commit();
+}
+
+void MetricsExporter::heartbeat() {
+    const qint64 late = mSinceHeartbeat.restart() - HEARTBEAT_INTERVAL;
+    if (late > STALL_THRESHOLD)
+        Metrics::guiStall(late * 1000);
+}
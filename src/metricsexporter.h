@@ -0,0 +1,55 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef metricsexporter_h
+#define metricsexporter_h
+
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// Makes the Metrics available to a collector, as configured:
+//
+//  - metrics/socket: a local socket in the user's runtime directory,
+//    pavucontrol-qt.metrics, that writes them to every client and closes;
+//  - metrics/file: a file rewritten every metrics/interval seconds (15 by
+//    default), e.g. for the textfile collector of the node exporter.
+//
+// Both are off by default. While either is on, a heartbeat timer also
+// measures how late the GUI event loop runs.
+class MetricsExporter : public QObject {
+    Q_OBJECT
+public:
+    explicit MetricsExporter(QObject *parent = nullptr);
+    ~MetricsExporter() override;
+
+private Q_SLOTS:
+    void onNewConnection();
+    void writeFile();
+    void heartbeat();
+
+private:
+    QLocalServer mServer;
+    QString mFile;
+    QTimer mFileTimer;
+    QTimer mHeartbeat;
+    QElapsedTimer mSinceHeartbeat;
+};
+
+#endif
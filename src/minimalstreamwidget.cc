@@ -23,9 +23,16 @@
 #endif
 
 #include "minimalstreamwidget.h"
+#include "metrics.h"
 #include <QGridLayout>
 #include <QProgressBar>
 #include <QDebug>
+#include <QTimer>
+
+/* about one frame: smooth to the ear without flooding the server */
+#define LIVE_VOLUME_INTERVAL 16
+
+bool MinimalStreamWidget::liveTracking = false;
 
 /*** MinimalStreamWidget ***/
 MinimalStreamWidget::MinimalStreamWidget(QWidget *parent) :
@@ -35,13 +42,27 @@ MinimalStreamWidget::MinimalStreamWidget(QWidget *parent) :
     peak(nullptr),
     updating(false),
     volumeMeterEnabled(false),
-    volumeMeterVisible(true) {
+    volumeMeterVisible(true),
+    volumeOperation(nullptr),
+    volumeSerial(0),
+    volumeNotify(nullptr),
+    volumeNotifyUserdata(nullptr),
+    volumeUpdatePending(false),
+    volumeThrottled(false) {
 
     peakProgressBar->setTextVisible(false);
     peakProgressBar->hide();
 }
 
 MinimalStreamWidget::~MinimalStreamWidget() {
+    if (volumeOperation) {
+        LOCK_MAINLOOP;
+        /* make sure the completion callback won't see a dangling widget; an
+         * event it already posted is discarded along with this object */
+        pa_operation_cancel(volumeOperation);
+        pa_operation_unref(volumeOperation);
+        volumeOperation = nullptr;
+    }
     if (peak != nullptr) {
         pa_stream_disconnect(peak);
         pa_stream_unref(peak);
@@ -66,6 +87,8 @@ void MinimalStreamWidget::updatePeak(double v) {
     if (v >= 0) {
         peakProgressBar->setEnabled(TRUE);
         int value = qRound(v * peakProgressBar->maximum());
+        if (value != peakProgressBar->value())
+            Metrics::meterSampleRendered();
         peakProgressBar->setValue(value);
     } else {
         peakProgressBar->setEnabled(FALSE);
@@ -95,3 +118,124 @@ void MinimalStreamWidget::setVolumeMeterVisible(bool v) {
         peakProgressBar->hide();
     }
 }
+
+pa_operation *MinimalStreamWidget::executeVolumeUpdate(pa_context_success_cb_t, void *) {
+    return nullptr;
+}
+
+void MinimalStreamWidget::fadeVolume(const pa_cvolume &, int) {
+}
+
+void MinimalStreamWidget::cancelFade() {
+}
+
+void MinimalStreamWidget::recordVolume(const pa_cvolume &, const pa_cvolume &) {
+}
+
+void MinimalStreamWidget::setLiveVolumeTracking(bool live) {
+    liveTracking = live;
+}
+
+bool MinimalStreamWidget::liveVolumeTracking() {
+    return liveTracking;
+}
+
+bool MinimalStreamWidget::volumeUpdateInFlight() const {
+    return volumeOperation != nullptr || volumeUpdatePending;
+}
+
+void MinimalStreamWidget::requestVolumeUpdate() {
+    volumeUpdatePending = true;
+
+    LOCK_MAINLOOP;
+
+    if (volumeOperation) {
+        /* its completion sends the latest value */
+        if (pa_operation_get_state(volumeOperation) != PA_OPERATION_CANCELLED)
+            return;
+        /* cancelled along with the context; the callback won't come */
+        pa_operation_unref(volumeOperation);
+        volumeOperation = nullptr;
+    }
+
+    if (volumeThrottled)
+        return;
+
+    if (liveTracking && volumeSent.isValid()) {
+        const qint64 wait = LIVE_VOLUME_INTERVAL - volumeSent.elapsed();
+        if (wait > 0) {
+            volumeThrottled = true;
+            QTimer::singleShot(static_cast<int>(wait), this, &MinimalStreamWidget::volumeThrottleDone);
+            return;
+        }
+    }
+
+    volumeUpdatePending = false;
+    issueVolumeUpdate(nullptr, nullptr);
+}
+
+pa_operation *MinimalStreamWidget::sendVolumeUpdate(pa_context_success_cb_t cb, void *userdata) {
+    cancelFade();
+
+    LOCK_MAINLOOP;
+
+    if (volumeOperation) {
+        /* a completion already on its way no longer matches volumeSerial */
+        pa_operation_cancel(volumeOperation);
+        pa_operation_unref(volumeOperation);
+        volumeOperation = nullptr;
+    }
+
+    volumeUpdatePending = false;
+    issueVolumeUpdate(cb, userdata);
+    return volumeOperation ? pa_operation_ref(volumeOperation) : nullptr;
+}
+
+void MinimalStreamWidget::issueVolumeUpdate(pa_context_success_cb_t cb, void *userdata) {
+    volumeSerial++;
+    volumeNotify = cb;
+    volumeNotifyUserdata = userdata;
+    volumeSent.start();
+    volumeOperation = executeVolumeUpdate(volumeOperationCallback, this);
+}
+
+void MinimalStreamWidget::volumeOperationCallback(pa_context *c, int success, void *userdata) {
+    MinimalStreamWidget *w = static_cast<MinimalStreamWidget*>(userdata);
+
+    /* Only the operation in flight can call back: a replaced one was cancelled */
+    if (w->volumeNotify)
+        w->volumeNotify(c, success, w->volumeNotifyUserdata);
+
+#ifdef USE_THREADED_PALOOP
+    if (PVCApplication::isQuitting())
+        return;
+    /* This runs with the mainloop locked, so the widget is not being destroyed
+     * right now; if it is before the event is delivered, the event goes too. */
+    QMetaObject::invokeMethod(w, "volumeUpdateDone", Qt::QueuedConnection, Q_ARG(uint, w->volumeSerial));
+#else
+    w->volumeUpdateDone(w->volumeSerial);
+#endif
+}
+
+void MinimalStreamWidget::volumeUpdateDone(uint serial) {
+    {
+        LOCK_MAINLOOP;
+
+        /* the operation was replaced in the meantime */
+        if (!volumeOperation || serial != volumeSerial)
+            return;
+
+        pa_operation_unref(volumeOperation);
+        volumeOperation = nullptr;
+    }
+
+    if (volumeUpdatePending)
+        requestVolumeUpdate();
+}
+
+void MinimalStreamWidget::volumeThrottleDone() {
+    volumeThrottled = false;
+
+    if (volumeUpdatePending)
+        requestVolumeUpdate();
+}
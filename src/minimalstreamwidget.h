@@ -22,6 +22,7 @@
 #define minimalstreamwidget_h
 
 #include "pavucontrol.h"
+#include <QElapsedTimer>
 #include <QWidget>
 
 class QProgressBar;
@@ -43,14 +44,64 @@ public:
     virtual void onMuteToggleButton() = 0;
     virtual void onLockToggleButton() = 0;
     virtual void updateChannelVolume(int channel, pa_volume_t v) = 0;
+    virtual void setVolumeTracking(bool tracking) = 0;
+
+    /* The volume the sliders show; applyVolume() shows a new one and sends it */
+    virtual const pa_cvolume &currentVolume() const = 0;
+    virtual void applyVolume(const pa_cvolume &v) = 0;
 
     bool volumeMeterEnabled;
     void enableVolumeMeter();
     void updatePeak(double v);
     void setVolumeMeterVisible(bool v);
 
+    /* Volume changes are sent right away, unless an earlier one is still
+     * in flight: then only the latest value is kept and sent as soon as
+     * that operation completes. */
+    void requestVolumeUpdate();
+    bool volumeUpdateInFlight() const;
+    /* For bulk changes: sends the volume right away, in place of any update
+     * still in flight, and also reports its completion to cb/userdata.
+     * Returns a reference to the operation, or null if it was not issued. */
+    pa_operation *sendVolumeUpdate(pa_context_success_cb_t cb, void *userdata);
+
+    /* With live tracking the sliders send their intermediate positions;
+     * these are additionally spaced at least LIVE_VOLUME_INTERVAL ms apart. */
+    static void setLiveVolumeTracking(bool live);
+    static bool liveVolumeTracking();
+
+    // issues the call that sets the volume, with cb/userdata as its completion callback
+    virtual pa_operation *executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata);
+
+    // fades the volume to v in durationMs, see FadeScheduler
+    virtual void fadeVolume(const pa_cvolume &v, int durationMs);
+    // stops a fade started by fadeVolume(), leaving the volume where it got to
+    virtual void cancelFade();
+
+    // adds a volume change made in this window to the ChangeHistory
+    virtual void recordVolume(const pa_cvolume &before, const pa_cvolume &after);
+
+private Q_SLOTS:
+    // serial is that of the operation that completed
+    void volumeUpdateDone(uint serial);
+    void volumeThrottleDone();
+
 private :
+    static void volumeOperationCallback(pa_context *c, int success, void *userdata);
+    void issueVolumeUpdate(pa_context_success_cb_t cb, void *userdata);
+
     bool volumeMeterVisible;
+    // the volume operation in flight and its serial; with the threaded mainloop,
+    // only changed with its lock held
+    pa_operation *volumeOperation;
+    uint volumeSerial;
+    pa_context_success_cb_t volumeNotify;
+    void *volumeNotifyUserdata;
+    bool volumeUpdatePending;
+    bool volumeThrottled;
+    QElapsedTimer volumeSent;
+
+    static bool liveTracking;
 
 };
 
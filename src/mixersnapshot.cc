@@ -0,0 +1,335 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "mixersnapshot.h"
+#include "mainwindow.h"
+#include "cardwidget.h"
+#include "sinkwidget.h"
+#include "sourcewidget.h"
+#include "sinkinputwidget.h"
+#include "sourceoutputwidget.h"
+#include "operationbatch.h"
+#include "operationstats.h"
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <map>
+
+#define SNAPSHOT_VERSION 1
+
+static inline QString str(const QByteArray &s) {
+    return QString::fromUtf8(s);
+}
+
+static QJsonArray volumeToJson(const pa_cvolume &v) {
+    QJsonArray a;
+    for (int i = 0; i < v.channels; i++)
+        a.append((qint64) v.values[i]);
+    return a;
+}
+
+/* A snapshot taken with another channel count applies its loudest channel to all */
+static pa_cvolume volumeFromJson(const QJsonArray &a, const pa_cvolume &current) {
+    pa_cvolume v = current;
+
+    if (a.size() == current.channels) {
+        for (int i = 0; i < v.channels; i++)
+            v.values[i] = (pa_volume_t) qBound<qint64>(PA_VOLUME_MUTED, (qint64) a[i].toDouble(), PA_VOLUME_MAX);
+    } else if (!a.isEmpty() && current.channels > 0) {
+        qint64 max = PA_VOLUME_MUTED;
+        for (const QJsonValue &c : a)
+            max = qMax(max, (qint64) c.toDouble());
+        pa_cvolume_set(&v, current.channels, (pa_volume_t) qMin<qint64>(max, PA_VOLUME_MAX));
+    }
+
+    return v;
+}
+
+template <typename Call>
+static void issue(OperationBatch *batch, OperationStats::Kind kind, Call call) {
+    OperationStats::Tracker t(kind, batch->callback(), batch->userdata());
+    pa_operation *o = call(t.callback(), t.userdata());
+
+    if (o)
+        t.attach(o);
+    batch->add(o);
+}
+
+QByteArray MixerSnapshot::streamKey(pa_proplist *proplist) {
+    const char *app = pa_proplist_gets(proplist, PA_PROP_APPLICATION_PROCESS_BINARY);
+    if (!app)
+        app = pa_proplist_gets(proplist, PA_PROP_APPLICATION_NAME);
+    const char *role = pa_proplist_gets(proplist, PA_PROP_MEDIA_ROLE);
+
+    QByteArray key(app ? app : "");
+    if (role) {
+        key += '|';
+        key += role;
+    }
+    return key;
+}
+
+template <typename Widget>
+static QJsonObject deviceToJson(const Widget *w) {
+    QJsonObject o;
+    o[QStringLiteral("name")] = str(w->name);
+    if (!w->activePort.isEmpty())
+        o[QStringLiteral("port")] = str(w->activePort);
+    o[QStringLiteral("volume")] = volumeToJson(w->volume);
+    o[QStringLiteral("mute")] = w->muteToggleButton->isChecked();
+    return o;
+}
+
+template <typename Widget>
+static QJsonObject streamToJson(const Widget *w, const QByteArray &device) {
+    QJsonObject o;
+    o[QStringLiteral("match")] = str(w->streamKey);
+    o[QStringLiteral("device")] = str(device);
+    o[QStringLiteral("volume")] = volumeToJson(w->volume);
+    o[QStringLiteral("mute")] = w->muteToggleButton->isChecked();
+    return o;
+}
+
+QByteArray MixerSnapshot::capture(const MainWindow *w) {
+    QJsonObject root;
+    root[QStringLiteral("version")] = SNAPSHOT_VERSION;
+    root[QStringLiteral("defaultSink")] = str(w->defaultSinkName);
+    root[QStringLiteral("defaultSource")] = str(w->defaultSourceName);
+
+    QJsonArray cards;
+    for (const auto &it : w->cardWidgets) {
+        QJsonObject o;
+        o[QStringLiteral("name")] = str(it.second->name);
+        o[QStringLiteral("profile")] = str(it.second->activeProfile);
+        cards.append(o);
+    }
+    root[QStringLiteral("cards")] = cards;
+
+    QJsonArray sinks;
+    for (const auto &it : w->sinkWidgets)
+        sinks.append(deviceToJson(it.second));
+    root[QStringLiteral("sinks")] = sinks;
+
+    QJsonArray sources;
+    for (const auto &it : w->sourceWidgets)
+        sources.append(deviceToJson(it.second));
+    root[QStringLiteral("sources")] = sources;
+
+    /* streams without an application to match them by cannot be restored */
+    QJsonArray sinkInputs;
+    for (const auto &it : w->sinkInputWidgets) {
+        if (it.second->streamKey.isEmpty())
+            continue;
+        auto sink = w->sinkWidgets.find(it.second->sinkIndex());
+        sinkInputs.append(streamToJson(it.second, sink != w->sinkWidgets.end() ? sink->second->name : QByteArray()));
+    }
+    root[QStringLiteral("sinkInputs")] = sinkInputs;
+
+    QJsonArray sourceOutputs;
+    for (const auto &it : w->sourceOutputWidgets) {
+        if (it.second->streamKey.isEmpty())
+            continue;
+        auto source = w->sourceWidgets.find(it.second->sourceIndex());
+        sourceOutputs.append(streamToJson(it.second, source != w->sourceWidgets.end() ? source->second->name : QByteArray()));
+    }
+    root[QStringLiteral("sourceOutputs")] = sourceOutputs;
+
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+template <typename Widget>
+static std::map<QByteArray, Widget*> byName(const std::map<uint32_t, Widget*> &widgets) {
+    std::map<QByteArray, Widget*> names;
+    for (const auto &it : widgets)
+        names[it.second->name] = it.second;
+    return names;
+}
+
+static std::map<QByteArray, QJsonObject> byKey(const QJsonArray &a, const QString &key) {
+    std::map<QByteArray, QJsonObject> objects;
+    for (const QJsonValue &v : a) {
+        const QJsonObject o = v.toObject();
+        objects[o[key].toString().toUtf8()] = o;
+    }
+    return objects;
+}
+
+bool MixerSnapshot::restore(MainWindow *w, const QByteArray &data, OperationBatch *batch, QString *error) {
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+
+    if (!doc.isObject()) {
+        *error = parseError.errorString();
+        return false;
+    }
+
+    const QJsonObject root = doc.object();
+    if (root[QStringLiteral("version")].toInt() != SNAPSHOT_VERSION) {
+        *error = QCoreApplication::translate("MainWindow", "Not a mixer snapshot, or one of an unknown version");
+        return false;
+    }
+
+    pa_context *c = get_context();
+
+    const auto cards = byName(w->cardWidgets);
+    for (const QJsonValue &v : root[QStringLiteral("cards")].toArray()) {
+        const QJsonObject o = v.toObject();
+        auto it = cards.find(o[QStringLiteral("name")].toString().toUtf8());
+        const QByteArray profile = o[QStringLiteral("profile")].toString().toUtf8();
+        if (it == cards.end() || profile.isEmpty() || it->second->activeProfile == profile)
+            continue;
+
+        const uint32_t index = it->second->index;
+        issue(batch, OperationStats::SetProfile, [&](pa_context_success_cb_t cb, void *ud) {
+            return pa_context_set_card_profile_by_index(c, index, profile.constData(), cb, ud);
+        });
+    }
+
+    const auto sinks = byName(w->sinkWidgets);
+    for (const QJsonValue &v : root[QStringLiteral("sinks")].toArray()) {
+        const QJsonObject o = v.toObject();
+        auto it = sinks.find(o[QStringLiteral("name")].toString().toUtf8());
+        if (it == sinks.end())
+            continue;
+
+        const SinkWidget *s = it->second;
+        const QByteArray port = o[QStringLiteral("port")].toString().toUtf8();
+        if (!port.isEmpty() && port != s->activePort)
+            issue(batch, OperationStats::SetPort, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_sink_port_by_index(c, s->index, port.constData(), cb, ud);
+            });
+
+        const pa_cvolume volume = volumeFromJson(o[QStringLiteral("volume")].toArray(), s->volume);
+        if (!pa_cvolume_equal(&volume, &s->volume))
+            issue(batch, OperationStats::SetVolume, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_sink_volume_by_index(c, s->index, &volume, cb, ud);
+            });
+
+        const bool mute = o[QStringLiteral("mute")].toBool();
+        if (mute != s->muteToggleButton->isChecked())
+            issue(batch, OperationStats::SetMute, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_sink_mute_by_index(c, s->index, mute, cb, ud);
+            });
+    }
+
+    const auto sources = byName(w->sourceWidgets);
+    for (const QJsonValue &v : root[QStringLiteral("sources")].toArray()) {
+        const QJsonObject o = v.toObject();
+        auto it = sources.find(o[QStringLiteral("name")].toString().toUtf8());
+        if (it == sources.end())
+            continue;
+
+        const SourceWidget *s = it->second;
+        const QByteArray port = o[QStringLiteral("port")].toString().toUtf8();
+        if (!port.isEmpty() && port != s->activePort)
+            issue(batch, OperationStats::SetPort, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_source_port_by_index(c, s->index, port.constData(), cb, ud);
+            });
+
+        const pa_cvolume volume = volumeFromJson(o[QStringLiteral("volume")].toArray(), s->volume);
+        if (!pa_cvolume_equal(&volume, &s->volume))
+            issue(batch, OperationStats::SetVolume, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_source_volume_by_index(c, s->index, &volume, cb, ud);
+            });
+
+        const bool mute = o[QStringLiteral("mute")].toBool();
+        if (mute != s->muteToggleButton->isChecked())
+            issue(batch, OperationStats::SetMute, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_source_mute_by_index(c, s->index, mute, cb, ud);
+            });
+    }
+
+    const QByteArray defaultSink = root[QStringLiteral("defaultSink")].toString().toUtf8();
+    if (!defaultSink.isEmpty() && defaultSink != w->defaultSinkName && sinks.count(defaultSink))
+        issue(batch, OperationStats::SetDefault, [&](pa_context_success_cb_t cb, void *ud) {
+            return pa_context_set_default_sink(c, defaultSink.constData(), cb, ud);
+        });
+
+    const QByteArray defaultSource = root[QStringLiteral("defaultSource")].toString().toUtf8();
+    if (!defaultSource.isEmpty() && defaultSource != w->defaultSourceName && sources.count(defaultSource))
+        issue(batch, OperationStats::SetDefault, [&](pa_context_success_cb_t cb, void *ud) {
+            return pa_context_set_default_source(c, defaultSource.constData(), cb, ud);
+        });
+
+    /* every live stream takes the settings of the snapshot's stream of the same application */
+    const auto sinkInputs = byKey(root[QStringLiteral("sinkInputs")].toArray(), QStringLiteral("match"));
+    for (const auto &it : w->sinkInputWidgets) {
+        const SinkInputWidget *s = it.second;
+        auto match = sinkInputs.find(s->streamKey);
+        if (s->streamKey.isEmpty() || match == sinkInputs.end())
+            continue;
+
+        const QJsonObject &o = match->second;
+        auto device = sinks.find(o[QStringLiteral("device")].toString().toUtf8());
+        if (device != sinks.end() && device->second->index != it.second->sinkIndex()) {
+            const uint32_t sink = device->second->index;
+            issue(batch, OperationStats::MoveStream, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_move_sink_input_by_index(c, s->index, sink, cb, ud);
+            });
+        }
+
+        const pa_cvolume volume = volumeFromJson(o[QStringLiteral("volume")].toArray(), s->volume);
+        if (!pa_cvolume_equal(&volume, &s->volume))
+            issue(batch, OperationStats::SetVolume, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_sink_input_volume(c, s->index, &volume, cb, ud);
+            });
+
+        const bool mute = o[QStringLiteral("mute")].toBool();
+        if (mute != s->muteToggleButton->isChecked())
+            issue(batch, OperationStats::SetMute, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_sink_input_mute(c, s->index, mute, cb, ud);
+            });
+    }
+
+    const auto sourceOutputs = byKey(root[QStringLiteral("sourceOutputs")].toArray(), QStringLiteral("match"));
+    for (const auto &it : w->sourceOutputWidgets) {
+        const SourceOutputWidget *s = it.second;
+        auto match = sourceOutputs.find(s->streamKey);
+        if (s->streamKey.isEmpty() || match == sourceOutputs.end())
+            continue;
+
+        const QJsonObject &o = match->second;
+        auto device = sources.find(o[QStringLiteral("device")].toString().toUtf8());
+        if (device != sources.end() && device->second->index != it.second->sourceIndex()) {
+            const uint32_t source = device->second->index;
+            issue(batch, OperationStats::MoveStream, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_move_source_output_by_index(c, s->index, source, cb, ud);
+            });
+        }
+
+#if HAVE_SOURCE_OUTPUT_VOLUMES
+        const pa_cvolume volume = volumeFromJson(o[QStringLiteral("volume")].toArray(), s->volume);
+        if (!pa_cvolume_equal(&volume, &s->volume))
+            issue(batch, OperationStats::SetVolume, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_source_output_volume(c, s->index, &volume, cb, ud);
+            });
+
+        const bool mute = o[QStringLiteral("mute")].toBool();
+        if (mute != s->muteToggleButton->isChecked())
+            issue(batch, OperationStats::SetMute, [&](pa_context_success_cb_t cb, void *ud) {
+                return pa_context_set_source_output_mute(c, s->index, mute, cb, ud);
+            });
+#endif
+    }
+
+    return true;
+}
@@ -0,0 +1,48 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef mixersnapshot_h
+#define mixersnapshot_h
+
+#include "pavucontrol.h"
+#include <QByteArray>
+#include <QString>
+
+class MainWindow;
+class OperationBatch;
+
+// The state of the whole mixer as a compact JSON document: card profiles,
+// device ports, volumes and mutes, the default devices, and the device and
+// volume of the streams. Streams are identified by their application and
+// media role (see streamKey()), so a snapshot can be restored in a later
+// session, to whatever streams are playing then.
+//
+// Everything is taken from the widgets, i.e. from what MainWindow::updateX()
+// received. Restoring compares the snapshot against the same and issues only
+// the operations that make a difference, all into one OperationBatch. Devices
+// that a profile change in the same restore brings up are not there yet when
+// it is computed; restoring a second time catches those.
+class MixerSnapshot {
+public:
+    static QByteArray capture(const MainWindow *w);
+    // false, with a message in error, if data is not a snapshot
+    static bool restore(MainWindow *w, const QByteArray &data, OperationBatch *batch, QString *error);
+
+    static QByteArray streamKey(pa_proplist *proplist);
+};
+
+#endif
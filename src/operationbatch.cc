@@ -0,0 +1,107 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "operationbatch.h"
+
+/* give up on operations that did not complete after this many ms */
+#define BATCH_TIMEOUT 10000
+
+OperationBatch::OperationBatch(QObject *parent) :
+    QObject(parent),
+    mSucceeded(0),
+    mFailed(0),
+    mNotIssued(0),
+    mCommitted(false),
+    mFinished(false) {
+
+    mElapsed.start();
+    mTimeout.setSingleShot(true);
+    mTimeout.setInterval(BATCH_TIMEOUT);
+    connect(&mTimeout, &QTimer::timeout, this, &OperationBatch::finish);
+}
+
+OperationBatch::~OperationBatch() {
+    for (pa_operation *o : mOperations) {
+        /* make sure no callback comes in for a batch that is gone */
+        if (pa_operation_get_state(o) == PA_OPERATION_RUNNING)
+            pa_operation_cancel(o);
+        pa_operation_unref(o);
+    }
+}
+
+pa_context_success_cb_t OperationBatch::callback() const {
+    return successCallback;
+}
+
+void *OperationBatch::userdata() {
+    return this;
+}
+
+void OperationBatch::add(pa_operation *o) {
+    if (o)
+        mOperations.push_back(o);
+    else
+        ++mNotIssued;
+}
+
+void OperationBatch::commit() {
+    mCommitted = true;
+
+    if (completed() >= static_cast<int>(mOperations.size()))
+        QTimer::singleShot(0, this, SLOT(finish()));
+    else
+        mTimeout.start();
+}
+
+void OperationBatch::successCallback(pa_context *, int success, void *userdata) {
+    OperationBatch *batch = static_cast<OperationBatch*>(userdata);
+
+#ifdef USE_THREADED_PALOOP
+    if (PVCApplication::isQuitting())
+        return;
+    QMetaObject::invokeMethod(batch, "operationDone", Qt::QueuedConnection, Q_ARG(bool, success));
+#else
+    batch->operationDone(success);
+#endif
+}
+
+void OperationBatch::operationDone(bool success) {
+    if (success)
+        ++mSucceeded;
+    else
+        ++mFailed;
+
+    if (mCommitted && completed() >= static_cast<int>(mOperations.size()))
+        finish();
+}
+
+void OperationBatch::finish() {
+    if (mFinished)
+        return;
+    mFinished = true;
+    mTimeout.stop();
+
+    /* operations still running now are the ones the timeout gave up on */
+    const int lost = static_cast<int>(mOperations.size()) - completed();
+
+    Q_EMIT finished(mSucceeded, mFailed + mNotIssued, lost, mElapsed.elapsed());
+    deleteLater();
+}
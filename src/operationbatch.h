@@ -0,0 +1,72 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef operationbatch_h
+#define operationbatch_h
+
+#include "pavucontrol.h"
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <vector>
+
+// A set of operations issued back to back, so that they are all written to
+// the server in the same mainloop iteration, and whose completion is reported
+// once: finished() is emitted when the last one completed, or after a timeout
+// for those that never will (e.g. because the connection dropped). The batch
+// deletes itself afterwards.
+//
+// Operations use callback()/userdata() as their completion callback and are
+// then handed over with add(), which keeps a reference until the batch is done.
+class OperationBatch : public QObject {
+    Q_OBJECT
+public:
+    explicit OperationBatch(QObject *parent = nullptr);
+    ~OperationBatch() override;
+
+    pa_context_success_cb_t callback() const;
+    void *userdata();
+
+    // a null operation, one that could not be issued, counts as failed
+    void add(pa_operation *o);
+    // no more operations will be added
+    void commit();
+
+    int size() const { return static_cast<int>(mOperations.size()); }
+
+Q_SIGNALS:
+    void finished(int succeeded, int failed, int lost, qint64 elapsedMs);
+
+private Q_SLOTS:
+    void operationDone(bool success);
+    void finish();
+
+private:
+    static void successCallback(pa_context *c, int success, void *userdata);
+    int completed() const { return mSucceeded + mFailed; }
+
+    std::vector<pa_operation*> mOperations;
+    int mSucceeded;
+    int mFailed;
+    int mNotIssued;
+    bool mCommitted;
+    bool mFinished;
+    QElapsedTimer mElapsed;
+    QTimer mTimeout;
+};
+
+#endif
@@ -0,0 +1,244 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "operationstats.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <chrono>
+
+OperationStats::Counters OperationStats::counters[OperationStats::KindCount];
+
+static uint64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct OperationStats::Pending {
+    Kind kind;
+    uint64_t issuedUs;
+    bool completed;
+    pa_context_success_cb_t cb;
+    void *userdata;
+};
+
+static const char *const kindNames[OperationStats::KindCount] = {
+    "set-volume",
+    "set-mute",
+    "move-stream",
+    "set-port",
+    "set-profile",
+    "set-default",
+    "kill",
+    "set-latency-offset",
+    "stream-restore",
+    "device-restore",
+    "rename-device",
+};
+
+const char *OperationStats::kindName(Kind kind) {
+    return kindNames[kind];
+}
+
+/*** Tracker ***/
+
+OperationStats::Tracker::Tracker(Kind kind, pa_context_success_cb_t cb, void *userdata) :
+    mPending(new Pending{kind, nowUs(), false, cb, userdata}) {
+}
+
+OperationStats::Tracker::~Tracker() {
+    if (mPending) {
+        counters[mPending->kind].issued.fetch_add(1, std::memory_order_relaxed);
+        counters[mPending->kind].failed.fetch_add(1, std::memory_order_relaxed);
+        delete mPending;
+    }
+}
+
+pa_context_success_cb_t OperationStats::Tracker::callback() const {
+    return OperationStats::successCallback;
+}
+
+void *OperationStats::Tracker::userdata() const {
+    return mPending;
+}
+
+void OperationStats::Tracker::attach(pa_operation *o) {
+    if (!o)
+        return;
+
+    counters[mPending->kind].issued.fetch_add(1, std::memory_order_relaxed);
+
+    /* From here on the operation owns the record: the success callback
+     * fills it in, the state callback frees it once the operation is done
+     * or has been cancelled. */
+    pa_operation_set_state_callback(o, OperationStats::stateCallback, mPending);
+    mPending = nullptr;
+}
+
+/*** OperationStats ***/
+
+void OperationStats::record(Kind kind, uint64_t us, bool success) {
+    Counters &c = counters[kind];
+
+    (success ? c.succeeded : c.failed).fetch_add(1, std::memory_order_relaxed);
+    c.totalUs.fetch_add(us, std::memory_order_relaxed);
+
+    uint64_t max = c.maxUs.load(std::memory_order_relaxed);
+    while (us > max && !c.maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed))
+        ;
+
+    int bucket = 0;
+    while (bucket < BucketCount - 1 && us >= bucketLimitUs(bucket))
+        ++bucket;
+    c.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void OperationStats::successCallback(pa_context *c, int success, void *userdata) {
+    Pending *p = static_cast<Pending*>(userdata);
+
+    p->completed = true;
+    record(p->kind, nowUs() - p->issuedUs, success);
+
+    if (p->cb)
+        p->cb(c, success, p->userdata);
+}
+
+void OperationStats::stateCallback(pa_operation *o, void *userdata) {
+    Pending *p = static_cast<Pending*>(userdata);
+
+    switch (pa_operation_get_state(o)) {
+        case PA_OPERATION_RUNNING:
+            return;
+        case PA_OPERATION_CANCELLED:
+            if (!p->completed)
+                counters[p->kind].cancelled.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case PA_OPERATION_DONE:
+            break;
+    }
+
+    pa_operation_set_state_callback(o, nullptr, nullptr);
+    delete p;
+}
+
+OperationStats::Snapshot OperationStats::snapshot(Kind kind) {
+    const Counters &c = counters[kind];
+    Snapshot s;
+
+    s.issued = c.issued.load(std::memory_order_relaxed);
+    s.succeeded = c.succeeded.load(std::memory_order_relaxed);
+    s.failed = c.failed.load(std::memory_order_relaxed);
+    s.cancelled = c.cancelled.load(std::memory_order_relaxed);
+    s.totalUs = c.totalUs.load(std::memory_order_relaxed);
+    s.maxUs = c.maxUs.load(std::memory_order_relaxed);
+    for (int i = 0; i < BucketCount; ++i)
+        s.buckets[i] = c.buckets[i].load(std::memory_order_relaxed);
+
+    return s;
+}
+
+void OperationStats::reset() {
+    for (auto &c : counters) {
+        c.issued.store(0, std::memory_order_relaxed);
+        c.succeeded.store(0, std::memory_order_relaxed);
+        c.failed.store(0, std::memory_order_relaxed);
+        c.cancelled.store(0, std::memory_order_relaxed);
+        c.totalUs.store(0, std::memory_order_relaxed);
+        c.maxUs.store(0, std::memory_order_relaxed);
+        for (auto &b : c.buckets)
+            b.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t OperationStats::Snapshot::percentileUs(double q) const {
+    uint64_t n = 0;
+    for (uint64_t b : buckets)
+        n += b;
+    if (n == 0)
+        return 0;
+
+    const uint64_t rank = static_cast<uint64_t>(q * (n - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount - 1; ++i) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return bucketLimitUs(i);
+    }
+    return maxUs;
+}
+
+QByteArray OperationStats::toText() {
+    QByteArray text;
+
+    text += QString::asprintf("%-20s %8s %8s %8s %9s %9s %9s %9s %9s\n",
+                              "operation", "issued", "failed", "cancel", "mean ms",
+                              "p50 ms", "p90 ms", "p99 ms", "max ms").toUtf8();
+
+    for (int k = 0; k < KindCount; ++k) {
+        const Snapshot s = snapshot(static_cast<Kind>(k));
+        if (s.issued == 0)
+            continue;
+
+        const double mean = s.completed() ? double(s.totalUs) / s.completed() / 1000 : 0;
+        text += QString::asprintf("%-20s %8llu %8llu %8llu %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                                  kindName(static_cast<Kind>(k)),
+                                  (unsigned long long) s.issued,
+                                  (unsigned long long) s.failed,
+                                  (unsigned long long) s.cancelled,
+                                  mean,
+                                  s.percentileUs(0.5) / 1000.0,
+                                  s.percentileUs(0.9) / 1000.0,
+                                  s.percentileUs(0.99) / 1000.0,
+                                  s.maxUs / 1000.0).toUtf8();
+    }
+
+    return text;
+}
+
+QByteArray OperationStats::toJson() {
+    QJsonArray limits;
+    for (int i = 0; i < BucketCount - 1; ++i)
+        limits.append(static_cast<qint64>(bucketLimitUs(i)));
+
+    QJsonObject operations;
+    for (int k = 0; k < KindCount; ++k) {
+        const Snapshot s = snapshot(static_cast<Kind>(k));
+        QJsonArray buckets;
+        for (uint64_t b : s.buckets)
+            buckets.append(static_cast<qint64>(b));
+
+        QJsonObject op;
+        op[QStringLiteral("issued")] = static_cast<qint64>(s.issued);
+        op[QStringLiteral("succeeded")] = static_cast<qint64>(s.succeeded);
+        op[QStringLiteral("failed")] = static_cast<qint64>(s.failed);
+        op[QStringLiteral("cancelled")] = static_cast<qint64>(s.cancelled);
+        op[QStringLiteral("total_us")] = static_cast<qint64>(s.totalUs);
+        op[QStringLiteral("max_us")] = static_cast<qint64>(s.maxUs);
+        op[QStringLiteral("buckets")] = buckets;
+        operations[QLatin1String(kindName(static_cast<Kind>(k)))] = op;
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("bucket_limits_us")] = limits;
+    root[QStringLiteral("operations")] = operations;
+    return QJsonDocument(root).toJson();
+}
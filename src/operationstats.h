@@ -0,0 +1,126 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef operationstats_h
+#define operationstats_h
+
+#include <pulse/pulseaudio.h>
+#include <QByteArray>
+#include <atomic>
+#include <stdint.h>
+
+// Latency and outcome of the control operations we send to the server,
+// per kind of operation. Each operation is timed from issue to completion
+// into a fixed set of power-of-two buckets; the counters are atomic since
+// the completions arrive on the mainloop thread.
+//
+// Call sites wrap their pa_context_* call with a Tracker:
+//
+//     OperationStats::Tracker t(OperationStats::SetMute);
+//     if (!(o = pa_context_set_sink_mute_by_index(c, idx, mute, t.callback(), t.userdata()))) {
+//         ...
+//     }
+//     t.attach(o);
+//
+// which chains to an optional completion callback of the caller.
+class OperationStats {
+public:
+    enum Kind {
+        SetVolume,
+        SetMute,
+        MoveStream,
+        SetPort,
+        SetProfile,
+        SetDefault,
+        Kill,
+        SetLatencyOffset,
+        StreamRestore,
+        DeviceRestore,
+        RenameDevice,
+        KindCount
+    };
+
+    /* bucket i counts the operations that took less than 64 << i µs,
+     * the last one everything slower */
+    static constexpr int BucketCount = 18;
+
+    struct Snapshot {
+        uint64_t issued;
+        uint64_t succeeded;
+        uint64_t failed;
+        uint64_t cancelled;
+        uint64_t totalUs;
+        uint64_t maxUs;
+        uint64_t buckets[BucketCount];
+
+        uint64_t completed() const { return succeeded + failed; }
+        // the upper bound of the bucket holding the given quantile, in µs
+        uint64_t percentileUs(double q) const;
+    };
+
+private:
+    struct Pending;
+
+public:
+    class Tracker {
+    public:
+        explicit Tracker(Kind kind, pa_context_success_cb_t cb = nullptr, void *userdata = nullptr);
+        ~Tracker();
+
+        pa_context_success_cb_t callback() const;
+        void *userdata() const;
+
+        // hands the issued operation over; a tracker that never got one
+        // counts its operation as failed
+        void attach(pa_operation *o);
+
+    private:
+        Tracker(const Tracker&) = delete;
+        Tracker &operator=(const Tracker&) = delete;
+
+        Pending *mPending;
+    };
+
+    static const char *kindName(Kind kind);
+    static Snapshot snapshot(Kind kind);
+    static void reset();
+
+    // a plain-text table for the diagnostics dialog, and JSON for saving
+    static QByteArray toText();
+    static QByteArray toJson();
+
+    static uint64_t bucketLimitUs(int bucket) { return uint64_t(64) << bucket; }
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> issued;
+        std::atomic<uint64_t> succeeded;
+        std::atomic<uint64_t> failed;
+        std::atomic<uint64_t> cancelled;
+        std::atomic<uint64_t> totalUs;
+        std::atomic<uint64_t> maxUs;
+        std::atomic<uint64_t> buckets[BucketCount];
+    };
+
+    static void record(Kind kind, uint64_t us, bool success);
+    static void successCallback(pa_context *c, int success, void *userdata);
+    static void stateCallback(pa_operation *o, void *userdata);
+
+    static Counters counters[KindCount];
+};
+
+#endif
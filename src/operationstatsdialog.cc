@@ -0,0 +1,89 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "operationstatsdialog.h"
+#include "operationstats.h"
+#include <QDialogButtonBox>
+#include <QFile>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QMessageBox>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+OperationStatsDialog::OperationStatsDialog(QWidget *parent) :
+    QDialog(parent),
+    mText(new QPlainTextEdit(this)) {
+
+    setWindowTitle(tr("Operation Statistics"));
+
+    mText->setReadOnly(true);
+    mText->setLineWrapMode(QPlainTextEdit::NoWrap);
+    mText->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Save | QDialogButtonBox::Reset | QDialogButtonBox::Close, this);
+    connect(buttons->button(QDialogButtonBox::Save), &QPushButton::clicked, this, &OperationStatsDialog::save);
+    connect(buttons->button(QDialogButtonBox::Reset), &QPushButton::clicked, this, &OperationStatsDialog::reset);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(mText);
+    layout->addWidget(buttons);
+    resize(760, 320);
+
+    mRefresh.setInterval(1000);
+    connect(&mRefresh, &QTimer::timeout, this, &OperationStatsDialog::refresh);
+}
+
+void OperationStatsDialog::showEvent(QShowEvent *event) {
+    refresh();
+    mRefresh.start();
+    QDialog::showEvent(event);
+}
+
+void OperationStatsDialog::hideEvent(QHideEvent *event) {
+    mRefresh.stop();
+    QDialog::hideEvent(event);
+}
+
+void OperationStatsDialog::refresh() {
+    mText->setPlainText(QString::fromUtf8(OperationStats::toText()));
+}
+
+void OperationStatsDialog::reset() {
+    OperationStats::reset();
+    refresh();
+}
+
+void OperationStatsDialog::save() {
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Save Operation Statistics"),
+                                                          QStringLiteral("pavucontrol-qt-operations.json"),
+                                                          tr("JSON files (*.json)"));
+    if (fileName.isEmpty())
+        return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(OperationStats::toJson()) < 0) {
+        QMessageBox::warning(this, tr("Save Operation Statistics"),
+                             tr("Could not write %1: %2").arg(fileName, file.errorString()));
+    }
+}
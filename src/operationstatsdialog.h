@@ -0,0 +1,46 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef operationstatsdialog_h
+#define operationstatsdialog_h
+
+#include <QDialog>
+#include <QTimer>
+
+class QPlainTextEdit;
+
+// Shows the OperationStats table, refreshed every second while open,
+// and saves the full histograms as JSON.
+class OperationStatsDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit OperationStatsDialog(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void refresh();
+    void reset();
+    void save();
+
+    QPlainTextEdit *mText;
+    QTimer mRefresh;
+};
+
+#endif
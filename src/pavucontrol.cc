@@ -46,6 +46,15 @@
 #include "sourceoutputwidget.h"
 #include "rolewidget.h"
 #include "mainwindow.h"
+#include "portlabels.h"
+#include "headlessclient.h"
+#include "jsondump.h"
+#include "commandscript.h"
+#include "jsonwatch.h"
+#include "controlserver.h"
+#include "metrics.h"
+#include "metricsexporter.h"
+#include "eventtrace.h"
 #include <QMessageBox>
 #include <QApplication>
 #include <QLocale>
@@ -55,12 +64,14 @@
 #include <QCommandLineOption>
 #include <QString>
 #include <QAbstractEventDispatcher>
+#include <QTimer>
 #ifndef NEEDS_INVOKE_METHOD_FUNCTOR
 #include <QThread>
 #endif
 #include <QDebug>
 
 #include <atomic>
+#include <map>
 
 static pa_context* context = nullptr;
 struct pa_threaded_mainloop *PVCApplication::pa_mainloop = nullptr;
@@ -87,6 +98,12 @@ void show_translated_error(const char *txt)
         .arg(QObject::tr(txt))
         .arg(pa_str);
 
+    if (pvcApp->headlessClient()) {
+        fprintf(stderr, "%s\n", message.toLocal8Bit().constData());
+        qApp->exit(1);
+        return;
+    }
+
     QMessageBox::critical(nullptr, QObject::tr("Error"), message);
     qApp->quit();
 }
@@ -104,6 +121,12 @@ void show_error(const char *txt) {
         .arg(QString::fromUtf8(txt))
         .arg(pa_str);
 
+    if (pvcApp->headlessClient()) {
+        fprintf(stderr, "%s\n", message.toLocal8Bit().constData());
+        qApp->exit(1);
+        return;
+    }
+
     QMessageBox::critical(nullptr, QObject::tr("Error"), message);
     qApp->quit();
 }
@@ -166,33 +189,45 @@ void PVCApplication::dec_outstanding()
 
     if (--n_outstanding <= 0) {
         // w->get_window()->set_cursor();
-        w->setConnectionState(true);
+        if (headless)
+            headless->enumerationDone();
+        else
+            w->setConnectionState(true);
     }
 }
 
 void PVCApplication::createEventRoleWidget()
 {
-    w->createEventRoleWidget();
+    if (w)
+        w->createEventRoleWidget();
 }
 
 void PVCApplication::setConnectionState(gboolean state)
 {
-    w->setConnectionState(state);
+    if (w)
+        w->setConnectionState(state);
 }
 
 void PVCApplication::removeAllWidgets()
 {
-    w->removeAllWidgets();
+    if (w)
+        w->removeAllWidgets();
 }
 
 void PVCApplication::updateDeviceVisibility()
 {
-    w->updateDeviceVisibility();
+    if (w)
+        w->updateDeviceVisibility();
 }
 
 void PVCApplication::reset()
 {
     qDebug() << Q_FUNC_INFO << "!";
+    if (headless) {
+        reconnect_timeout = -1;
+        headless->connectionFailed();
+        return;
+    }
     w->setConnectionState(false);
     w->removeAllWidgets();
     w->updateDeviceVisibility();
@@ -230,7 +265,10 @@ void PVCApplication::card_cb(const pa_card_info *i, int eol)
         return;
     }
 
-    w->updateCard(*i);
+    if (headless)
+        headless->updateCard(*i);
+    else
+        w->updateCard(*i);
 }
 
 void PVCApplication::sink_cb(pa_context *c, const pa_sink_info *i, int eol)
@@ -247,6 +285,10 @@ void PVCApplication::sink_cb(pa_context *c, const pa_sink_info *i, int eol)
         dec_outstanding();
         return;
     }
+    if (headless) {
+        headless->updateSink(*i);
+        return;
+    }
 #if HAVE_EXT_DEVICE_RESTORE_API
     if (w->updateSink(*i))
         ext_device_restore_subscribe_cb(c, PA_DEVICE_TYPE_SINK, i->index, this);
@@ -270,7 +312,10 @@ void PVCApplication::source_cb(const pa_source_info *i, int eol)
         return;
     }
 
-    w->updateSource(*i);
+    if (headless)
+        headless->updateSource(*i);
+    else
+        w->updateSource(*i);
 }
 
 void PVCApplication::sink_input_cb(const pa_sink_input_info *i, int eol)
@@ -288,7 +333,10 @@ void PVCApplication::sink_input_cb(const pa_sink_input_info *i, int eol)
         return;
     }
 
-    w->updateSinkInput(*i);
+    if (headless)
+        headless->updateSinkInput(*i);
+    else
+        w->updateSinkInput(*i);
 }
 
 void PVCApplication::source_output_cb(const pa_source_output_info *i, int eol)
@@ -303,22 +351,11 @@ void PVCApplication::source_output_cb(const pa_source_output_info *i, int eol)
 
     if (eol > 0)  {
 
-        if (n_outstanding > 0) {
+        if (n_outstanding > 0 && w) {
             /* At this point all notebook pages have been populated, so
              * let's open one that isn't empty */
             if (default_tab != -1) {
-                if (default_tab < 1 || default_tab > w->notebook->count()) {
-                    if (!w->sinkInputWidgets.empty())
-                        w->notebook->setCurrentIndex(0);
-                    else if (!w->sourceOutputWidgets.empty())
-                        w->notebook->setCurrentIndex(1);
-                    else if (!w->sourceWidgets.empty() && w->sinkWidgets.empty())
-                        w->notebook->setCurrentIndex(3);
-                    else
-                        w->notebook->setCurrentIndex(2);
-                } else {
-                    w->notebook->setCurrentIndex(default_tab - 1);
-                }
+                w->selectTab(default_tab);
                 default_tab = -1;
             }
         }
@@ -327,7 +364,10 @@ void PVCApplication::source_output_cb(const pa_source_output_info *i, int eol)
         return;
     }
 
-    w->updateSourceOutput(*i);
+    if (headless)
+        headless->updateSourceOutput(*i);
+    else
+        w->updateSourceOutput(*i);
 }
 
 void PVCApplication::client_cb(const pa_client_info *i, int eol)
@@ -345,7 +385,10 @@ void PVCApplication::client_cb(const pa_client_info *i, int eol)
         return;
     }
 
-    w->updateClient(*i);
+    if (headless)
+        headless->updateClient(*i);
+    else
+        w->updateClient(*i);
 }
 
 void PVCApplication::server_info_cb(const pa_server_info *i)
@@ -355,7 +398,10 @@ void PVCApplication::server_info_cb(const pa_server_info *i)
         return;
     }
 
-    w->updateServer(*i);
+    if (headless)
+        headless->updateServer(*i);
+    else
+        w->updateServer(*i);
     dec_outstanding();
 }
 
@@ -366,7 +412,8 @@ void PVCApplication::ext_stream_restore_read_cb(
     if (eol < 0) {
         dec_outstanding();
         qDebug(tr("Failed to initialize stream_restore extension: %s").toUtf8().constData(), pa_strerror(pa_context_errno(context)));
-        w->deleteEventRoleWidget();
+        if (w)
+            w->deleteEventRoleWidget();
         return;
     }
 
@@ -376,7 +423,10 @@ void PVCApplication::ext_stream_restore_read_cb(
     }
 
     const pa_ext_stream_restore_info *i = static_cast<const pa_ext_stream_restore_info*>(info);
-    w->updateRole(*i);
+    if (headless)
+        headless->updateRole(*i);
+    else
+        w->updateRole(*i);
 }
 
 
@@ -398,7 +448,8 @@ void PVCApplication::ext_device_restore_read_cb(
 
     /* Do something with a widget when this part is written */
     const pa_ext_device_restore_info *i = static_cast<const pa_ext_device_restore_info*>(info);
-    w->updateDeviceInfo(*i);
+    if (w)
+        w->updateDeviceInfo(*i);
 #endif
 }
 
@@ -410,7 +461,8 @@ void PVCApplication::ext_device_manager_read_cb(int eol)
         return;
     }
 
-    w->canRenameDevices = true;
+    if (w)
+        w->canRenameDevices = true;
 
     if (eol > 0) {
         dec_outstanding();
@@ -423,39 +475,65 @@ void PVCApplication::ext_device_manager_read_cb(int eol)
 }
 
 
+void PVCApplication::subscriptionEvent(pa_subscription_event_type_t t, uint32_t index)
+{
+    if (headless)
+        headless->subscriptionEvent(t, index);
+}
+
 void PVCApplication::removeSink(uint32_t index)
 {
-    w->removeSink(index);
+    if (headless)
+        headless->remove(PA_SUBSCRIPTION_EVENT_SINK, index);
+    else
+        w->removeSink(index);
 }
 
 void PVCApplication::removeSource(uint32_t index)
 {
-    w->removeSource(index);
+    if (headless)
+        headless->remove(PA_SUBSCRIPTION_EVENT_SOURCE, index);
+    else
+        w->removeSource(index);
 }
 
 void PVCApplication::removeSinkInput(uint32_t index)
 {
-    w->removeSinkInput(index);
+    if (headless)
+        headless->remove(PA_SUBSCRIPTION_EVENT_SINK_INPUT, index);
+    else
+        w->removeSinkInput(index);
 }
 
 void PVCApplication::removeSourceOutput(uint32_t index)
 {
-    w->removeSourceOutput(index);
+    if (headless)
+        headless->remove(PA_SUBSCRIPTION_EVENT_SOURCE_OUTPUT, index);
+    else
+        w->removeSourceOutput(index);
 }
 
 void PVCApplication::removeClient(uint32_t index)
 {
-    w->removeClient(index);
+    if (headless)
+        headless->remove(PA_SUBSCRIPTION_EVENT_CLIENT, index);
+    else
+        w->removeClient(index);
 }
 
 void PVCApplication::removeCard(uint32_t index)
 {
-    w->removeCard(index);
+    if (headless)
+        headless->remove(PA_SUBSCRIPTION_EVENT_CARD, index);
+    else
+        w->removeCard(index);
 }
 // ======= PVCApplication end @implementation ======= //
 
 
 void card_cb(pa_context *, const pa_card_info *i, int eol, void *userdata) {
+    if (!eol && EventTrace::recording())
+        EventTrace::info(*i);
     PVCAPP_FUNCTION(userdata, card_cb(i, eol));
 // PVCAPP_FUNCTION expands to:
 // #ifdef USE_THREADED_PALOOP
@@ -468,26 +546,38 @@ void card_cb(pa_context *, const pa_card_info *i, int eol, void *userdata) {
 }
 
 void sink_cb(pa_context *c, const pa_sink_info *i, int eol, void *userdata) {
+    if (!eol && EventTrace::recording())
+        EventTrace::info(*i);
     PVCAPP_FUNCTION(userdata, sink_cb(c, i, eol));
 }
 
 void source_cb(pa_context *, const pa_source_info *i, int eol, void *userdata) {
+    if (!eol && EventTrace::recording())
+        EventTrace::info(*i);
     PVCAPP_FUNCTION(userdata, source_cb(i, eol));
 }
 
 void sink_input_cb(pa_context *, const pa_sink_input_info *i, int eol, void *userdata) {
+    if (!eol && EventTrace::recording())
+        EventTrace::info(*i);
     PVCAPP_FUNCTION(userdata, sink_input_cb(i, eol));
 }
 
 void source_output_cb(pa_context *, const pa_source_output_info *i, int eol, void *userdata) {
+    if (!eol && EventTrace::recording())
+        EventTrace::info(*i);
     PVCAPP_FUNCTION(userdata, source_output_cb(i, eol));
 }
 
 void client_cb(pa_context *, const pa_client_info *i, int eol, void *userdata) {
+    if (!eol && EventTrace::recording())
+        EventTrace::info(*i);
     PVCAPP_FUNCTION(userdata, client_cb(i, eol));
 }
 
 void server_info_cb(pa_context *, const pa_server_info *i, void *userdata) {
+    if (i && EventTrace::recording())
+        EventTrace::info(*i);
     PVCAPP_FUNCTION(userdata, server_info_cb(i));
 }
 
@@ -563,12 +653,53 @@ static void ext_device_manager_subscribe_cb(pa_context *c, void *userdata) {
     pa_operation_unref(o);
 }
 
+// The info queries issued for subscription events, per object, kept only to count the
+// events that arrive while the query for an earlier one is still running: a single query
+// would have answered both. Only used from the mainloop callbacks, so there is no locking.
+static std::map<std::pair<int, uint32_t>, pa_operation *> infoQueries;
+
+static void track_info_query(int facility, uint32_t index, pa_operation *o) {
+    Metrics::infoQueryIssued(facility);
+
+    pa_operation *&previous = infoQueries[std::make_pair(facility, index)];
+    if (previous) {
+        if (pa_operation_get_state(previous) == PA_OPERATION_RUNNING)
+            Metrics::infoQueryCoalescable(facility);
+        pa_operation_unref(previous);
+    }
+    previous = o;
+}
+
+static void forget_info_query(int facility, uint32_t index) {
+    auto it = infoQueries.find(std::make_pair(facility, index));
+    if (it != infoQueries.end()) {
+        pa_operation_unref(it->second);
+        infoQueries.erase(it);
+    }
+}
+
+static void forget_info_queries() {
+    for (auto &q : infoQueries)
+        pa_operation_unref(q.second);
+    infoQueries.clear();
+}
+
 // toplevel subscription/interface callback. It contains more calls into PA code that require
 // callbacks into our own code than calls interacting with the GUI that need to be executed on
 // the main thread. So we keep this function out of PVCApplication and only place those GUI
 // calls via PVCAPP_FUNCTION().
 void subscribe_cb(pa_context *c, pa_subscription_event_type_t t, uint32_t index, void *userdata) {
-    switch (t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK) {
+    const int facility = t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK;
+
+    Metrics::subscriptionEvent(facility);
+    if (EventTrace::recording())
+        EventTrace::event(t, index);
+    if (pvcApp->headlessClient())
+        PVCAPP_FUNCTION(userdata, subscriptionEvent(t, index));
+    if ((t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE)
+        forget_info_query(facility, index);
+
+    switch (facility) {
         case PA_SUBSCRIPTION_EVENT_SINK:
             if ((t & PA_SUBSCRIPTION_EVENT_TYPE_MASK) == PA_SUBSCRIPTION_EVENT_REMOVE) {
                 PVCAPP_FUNCTION(userdata, removeSink(index));
@@ -578,7 +709,7 @@ void subscribe_cb(pa_context *c, pa_subscription_event_type_t t, uint32_t index,
                     show_translated_error("pa_context_get_sink_info_by_index() failed");
                     return;
                 }
-                pa_operation_unref(o);
+                track_info_query(facility, index, o);
             }
             break;
 
@@ -591,7 +722,7 @@ void subscribe_cb(pa_context *c, pa_subscription_event_type_t t, uint32_t index,
                     show_translated_error("pa_context_get_source_info_by_index() failed");
                     return;
                 }
-                pa_operation_unref(o);
+                track_info_query(facility, index, o);
             }
             break;
 
@@ -604,7 +735,7 @@ void subscribe_cb(pa_context *c, pa_subscription_event_type_t t, uint32_t index,
                     show_translated_error("pa_context_get_sink_input_info() failed");
                     return;
                 }
-                pa_operation_unref(o);
+                track_info_query(facility, index, o);
             }
             break;
 
@@ -617,7 +748,7 @@ void subscribe_cb(pa_context *c, pa_subscription_event_type_t t, uint32_t index,
                     show_translated_error("pa_context_get_sink_input_info() failed");
                     return;
                 }
-                pa_operation_unref(o);
+                track_info_query(facility, index, o);
             }
             break;
 
@@ -630,7 +761,7 @@ void subscribe_cb(pa_context *c, pa_subscription_event_type_t t, uint32_t index,
                     show_translated_error("pa_context_get_client_info() failed");
                     return;
                 }
-                pa_operation_unref(o);
+                track_info_query(facility, index, o);
             }
             break;
 
@@ -640,7 +771,7 @@ void subscribe_cb(pa_context *c, pa_subscription_event_type_t t, uint32_t index,
                     show_translated_error("pa_context_get_server_info() failed");
                     return;
                 }
-                pa_operation_unref(o);
+                track_info_query(facility, index, o);
             }
             break;
 
@@ -653,12 +784,12 @@ void subscribe_cb(pa_context *c, pa_subscription_event_type_t t, uint32_t index,
                     show_translated_error("pa_context_get_card_info_by_index() failed");
                     return;
                 }
-                pa_operation_unref(o);
+                track_info_query(facility, index, o);
             }
             break;
         default:
             qWarning() << Q_FUNC_INFO << "Unhandled subscribed event type" << t
-                << "(" << (t & PA_SUBSCRIPTION_EVENT_FACILITY_MASK) << ")";
+                << "(" << facility << ")";
             break;
     }
 }
@@ -682,19 +813,27 @@ void context_state_callback(pa_context *c, void *userdata) {
             // variables. They're std::atomic to be sure.
             reconnect_timeout = 1;
 
+            if (EventTrace::recording())
+                EventTrace::connected();
+
             /* Create event widget immediately so it's first in the list */
             PVCAPP_FUNCTION(userdata, createEventRoleWidget());
 
             pa_context_set_subscribe_callback(c, subscribe_cb, userdata);
 
-            if (!(o = pa_context_subscribe(c, (pa_subscription_mask_t)
+            pa_subscription_mask_t mask = (pa_subscription_mask_t)
                                            (PA_SUBSCRIPTION_MASK_SINK|
                                             PA_SUBSCRIPTION_MASK_SOURCE|
                                             PA_SUBSCRIPTION_MASK_SINK_INPUT|
                                             PA_SUBSCRIPTION_MASK_SOURCE_OUTPUT|
                                             PA_SUBSCRIPTION_MASK_CLIENT|
                                             PA_SUBSCRIPTION_MASK_SERVER|
-                                            PA_SUBSCRIPTION_MASK_CARD), nullptr, nullptr))) {
+                                            PA_SUBSCRIPTION_MASK_CARD);
+            /* the command line modes may not care for all of them */
+            if (pvcApp->headlessClient())
+                mask = pvcApp->headlessClient()->subscriptionMask();
+
+            if (!(o = pa_context_subscribe(c, mask, nullptr, nullptr))) {
                 show_translated_error("pa_context_subscribe() failed");
                 return;
             }
@@ -797,11 +936,12 @@ void context_state_callback(pa_context *c, void *userdata) {
         }
 
         case PA_CONTEXT_FAILED:
+            forget_info_queries();
             PVCAPP_FUNCTION(userdata, reset());
             pa_context_unref(context);
             context = nullptr;
 
-            if (reconnect_timeout > 0) {
+            if (reconnect_timeout > 0 && !pvcApp->headlessClient()) {
                 qWarning() << QObject::tr("Connection failed, attempting reconnect").toUtf8().constData();
 //                 g_timeout_add_seconds(reconnect_timeout, connect_to_pulse, userdata);
                 // the reconnection attempt has to be performed on the main thread, but no need
@@ -812,6 +952,7 @@ void context_state_callback(pa_context *c, void *userdata) {
 
         case PA_CONTEXT_TERMINATED:
         default:
+            forget_info_queries();
             if (!pvcApp->isQuitting()) {
                 PVCAPP_FUNCTION_CHECK(userdata, quit());
             }
@@ -823,6 +964,10 @@ pa_context* get_context() {
   return context;
 }
 
+pa_mainloop_api* get_mainloop_api() {
+  return api;
+}
+
 gboolean connect_to_pulse(gpointer userdata) {
 
     if (context)
@@ -841,14 +986,21 @@ gboolean connect_to_pulse(gpointer userdata) {
 
     pa_context_set_state_callback(context, context_state_callback, userdata);
 
-    pvcApp->mainWindow()->setConnectingMessage();
+    if (pvcApp->mainWindow())
+        pvcApp->mainWindow()->setConnectingMessage();
 #ifdef __APPLE__
     pa_context_flags_t connectFlags = PA_CONTEXT_NOAUTOSPAWN;
 #else
     pa_context_flags_t connectFlags = pa_context_flags_t(PA_CONTEXT_NOFAIL|PA_CONTEXT_NOAUTOSPAWN);
 #endif
+    /* the command line modes report a missing server rather than wait for one */
+    if (pvcApp->headlessClient())
+        connectFlags = PA_CONTEXT_NOAUTOSPAWN;
     if (pa_context_connect(context, nullptr, connectFlags, nullptr) < 0) {
-        if (pa_context_errno(context) == PA_ERR_INVALID) {
+        if (pvcApp->headlessClient()) {
+            reconnect_timeout = -1;
+            pvcApp->headlessClient()->connectionFailed();
+        } else if (pa_context_errno(context) == PA_ERR_INVALID) {
             pvcApp->mainWindow()->setConnectingMessage(QObject::tr("Connection to PulseAudio failed. Automatic retry in 5s.<br><br>"
                 "In this case this is likely because PULSE_SERVER in the Environment/X11 Root Window Properties"
                 "or default-server in client.conf is misconfigured.<br>"
@@ -905,13 +1057,33 @@ gboolean connect_to_pulse(gpointer userdata) {
  * @param argv p_argv:...
  * @return int
  */
-int main(int argc, char *argv[]) {
+/* The update path benchmark links the whole program and brings it up from a
+ * main() of its own, see src/benchmarks/mainwindow_bench.cc */
+#ifndef PAVUCONTROL_MAIN
+#define PAVUCONTROL_MAIN main
+#endif
+
+int PAVUCONTROL_MAIN(int argc, char *argv[]) {
 
     signal(SIGPIPE, SIG_IGN);
 
     n_outstanding = 0;
     reconnect_timeout = 1;
 
+    /* The command line modes must never open the display */
+    bool headless = false;
+    for (int i = 1; i < argc; i++) {
+        if (HeadlessClient::isHeadlessArgument(argv[i])) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+            headless = true;
+            break;
+        }
+    }
+
+    /* A window is already open: show that one instead */
+    if (!headless && ControlServer::activateRunningInstance(argc, argv))
+        return 0;
+
     PVCApplication app(argc, argv);
 
     app.setOrganizationName(QStringLiteral("pavucontrol-qt"));
@@ -926,6 +1098,9 @@ int main(int argc, char *argv[]) {
     if(appTranslator.load(QStringLiteral("pavucontrol-qt_") + locale, QStringLiteral(PAVUCONTROL_QT_DATA_DIR) + QStringLiteral("/translations")))
         qApp->installTranslator(&appTranslator);
 
+    /* Resolve the port and profile label suffixes once the translators are in place */
+    PortLabels::init();
+
     QCommandLineParser parser;
     parser.setApplicationDescription(QObject::tr("PulseAudio Volume Control"));
     parser.addHelpOption();
@@ -944,17 +1119,74 @@ int main(int argc, char *argv[]) {
     QCommandLineOption maximizeOption(QStringList() << QStringLiteral("maximize") << QStringLiteral("m"), QObject::tr("Maximize the window."));
     parser.addOption(maximizeOption);
 
+    QCommandLineOption newInstanceOption(QStringLiteral("new-instance"), QObject::tr("Open a new window even if one is already running."));
+    parser.addOption(newInstanceOption);
+
+    QCommandLineOption dumpJsonOption(QStringLiteral("dump-json"), QObject::tr("Write the audio graph as JSON to the standard output and exit."));
+    parser.addOption(dumpJsonOption);
+
+    QCommandLineOption applyOption(QStringLiteral("apply"), QObject::tr("Apply the changes listed in a command file (- for the standard input) and exit."), QStringLiteral("file"));
+    parser.addOption(applyOption);
+
+    QCommandLineOption watchOption(QStringLiteral("watch"), QObject::tr("Write every change of the audio graph as a line of JSON to the standard output."));
+    parser.addOption(watchOption);
+
+    QCommandLineOption watchFacilitiesOption(QStringLiteral("watch-facilities"), QObject::tr("Only watch the given comma separated facilities (sink, source, sink-input, source-output, client, server, card)."), QStringLiteral("list"));
+    parser.addOption(watchFacilitiesOption);
+
+    QCommandLineOption recordTraceOption(QStringLiteral("record-trace"), QObject::tr("Record the events, info records and peak meter samples received from the server to a binary trace file."), QStringLiteral("file"));
+    parser.addOption(recordTraceOption);
+
     parser.process(app);
     default_tab = parser.value(tabOption).toInt();
     retry = parser.isSet(retryOption);
 
+    if (parser.isSet(recordTraceOption)) {
+        QString error;
+        if (!EventTrace::start(parser.value(recordTraceOption), &error)) {
+            fprintf(stderr, "%s\n", error.toLocal8Bit().constData());
+            return 1;
+        }
+    }
+
     // ca_context_set_driver(ca_gtk_context_get(), "pulse");
 
-    MainWindow* mainWindow = new MainWindow();
-    if(parser.isSet(maximizeOption))
-        mainWindow->showMaximized();
+    MainWindow* mainWindow = nullptr;
+    ControlServer *controlServer = nullptr;
+    MetricsExporter *metricsExporter = nullptr;
+    HeadlessClient *headlessClient = nullptr;
+    if (parser.isSet(dumpJsonOption)) {
+        headlessClient = new JsonDump;
+    } else if (parser.isSet(applyOption)) {
+        QString error;
+        headlessClient = CommandScript::load(parser.value(applyOption), &error);
+        if (!headlessClient) {
+            fprintf(stderr, "%s\n", error.toLocal8Bit().constData());
+            return 1;
+        }
+    } else if (parser.isSet(watchOption)) {
+        QString error;
+        headlessClient = JsonWatch::create(parser.value(watchFacilitiesOption), &error);
+        if (!headlessClient) {
+            fprintf(stderr, "%s\n", error.toLocal8Bit().constData());
+            return 1;
+        }
+    }
+
+    if (headlessClient) {
+        app.setHeadlessClient(headlessClient);
+    } else {
+        mainWindow = new MainWindow();
+        if(parser.isSet(maximizeOption))
+            mainWindow->showMaximized();
+
+        app.setMainWindow(mainWindow);
+
+        controlServer = new ControlServer(mainWindow);
+        controlServer->listen();
 
-    app.setMainWindow(mainWindow);
+        metricsExporter = new MetricsExporter;
+    }
 
 #ifdef USE_THREADED_PALOOP
     pvcApp->setPAMainLoop(pa_threaded_mainloop_new());
@@ -969,21 +1201,31 @@ int main(int argc, char *argv[]) {
     g_assert(api);
 #endif
 
+    int ret = 0;
     connect_to_pulse(&app);
     if (reconnect_timeout >= 0) {
-        mainWindow->show();
-        app.exec();
+        if (mainWindow)
+            mainWindow->show();
+        ret = app.exec();
     }
 
-    if (reconnect_timeout < 0)
-        show_translated_error("Fatal Error: Unable to connect to PulseAudio");
+    if (reconnect_timeout < 0) {
+        /* the command line modes have reported the failure themselves */
+        if (!headlessClient)
+            show_translated_error("Fatal Error: Unable to connect to PulseAudio");
+        ret = 1;
+    }
 
+    delete metricsExporter;
+    delete controlServer;
     delete mainWindow;
+    delete headlessClient;
 
     if (context) {
         pa_context_disconnect(context);
         pa_context_unref(context);
     }
+    EventTrace::stop();
 
 // Be nice and free the pa_glib_mainloop used with Qt's GLib-based event dispatcher.
 // Don't do the equivalent when using the pa_threaded_mainloop so it can do its own
@@ -992,5 +1234,5 @@ int main(int argc, char *argv[]) {
     pa_glib_mainloop_free(m);
 #endif
 
-    return 0;
+    return ret;
 }
@@ -77,6 +77,7 @@ enum SourceType {
 };
 
 pa_context* get_context(void);
+pa_mainloop_api* get_mainloop_api(void);
 void show_error(const char *txt);
 void show_translated_error(const char *txt);
 
@@ -85,6 +86,7 @@ void show_translated_error(const char *txt);
 #define pvcApp          PVCApplication::instance()
 
 class MainWindow;
+class HeadlessClient;
 
 class PVCApplication : public QApplication
 {
@@ -103,6 +105,17 @@ public:
         return w;
     }
 
+    // set instead of a main window in the command line modes
+    void setHeadlessClient(HeadlessClient *client)
+    {
+        headless = client;
+    }
+
+    HeadlessClient *headlessClient()
+    {
+        return headless;
+    }
+
     static PVCApplication *instance()
     {
         return self;
@@ -180,13 +193,15 @@ public slots:
     void removeSourceOutput(uint32_t index);
     void removeClient(uint32_t index);
     void removeCard(uint32_t index);
+    void subscriptionEvent(pa_subscription_event_type_t t, uint32_t index);
 public:
     // keep our own cached thread pointer to save on some function calls
     const QThread *mainThread = nullptr;
 private:
     bool hasGlib;
 
-    MainWindow *w;
+    MainWindow *w = nullptr;
+    HeadlessClient *headless = nullptr;
     static PVCApplication *self;
     static std::atomic<bool> quitting;
 
@@ -194,6 +209,31 @@ private:
     static struct pa_threaded_mainloop *pa_mainloop;
 };
 
+#ifdef USE_THREADED_PALOOP
+// Holds the threaded mainloop's lock for the current scope, for state that is
+// set up from the GUI thread and used by the callbacks on the mainloop's; does
+// nothing on the mainloop thread itself, which already holds it.
+class MainloopLocker {
+public:
+    MainloopLocker() : mLoop(pvcApp->paMainLoop()) {
+        if (mLoop && pa_threaded_mainloop_in_thread(mLoop))
+            mLoop = nullptr;
+        if (mLoop)
+            pa_threaded_mainloop_lock(mLoop);
+    }
+    ~MainloopLocker() {
+        if (mLoop)
+            pa_threaded_mainloop_unlock(mLoop);
+    }
+
+private:
+    pa_threaded_mainloop *mLoop;
+};
+#define LOCK_MAINLOOP MainloopLocker locker
+#else
+#define LOCK_MAINLOOP
+#endif
+
 #ifdef NEEDS_PCVAPP_FUNCTIONS
 
 #ifdef NEEDS_INVOKE_METHOD_FUNCTOR
@@ -0,0 +1,82 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "portlabels.h"
+#include <pulse/def.h>
+#include <QCoreApplication>
+#include <string.h>
+
+// the suffixes have always been translated in the MainWindow context
+static const char *const pluggedInSource = QT_TRANSLATE_NOOP("MainWindow", " (plugged in)");
+static const char *const unpluggedSource = QT_TRANSLATE_NOOP("MainWindow", " (unplugged)");
+static const char *const unavailableSource = QT_TRANSLATE_NOOP("MainWindow", " (unavailable)");
+
+bool PortLabels::initialized = false;
+QByteArray PortLabels::pluggedIn;
+QByteArray PortLabels::unplugged;
+QByteArray PortLabels::unavailable;
+
+void PortLabels::init() {
+    pluggedIn = QCoreApplication::translate("MainWindow", pluggedInSource).toUtf8();
+    unplugged = QCoreApplication::translate("MainWindow", unpluggedSource).toUtf8();
+    unavailable = QCoreApplication::translate("MainWindow", unavailableSource).toUtf8();
+    initialized = true;
+}
+
+bool PortLabels::isInternalPort(const char *name) {
+    return strcmp(name, "analog-output-speaker") == 0
+        || strcmp(name, "analog-input-microphone-internal") == 0;
+}
+
+static inline QByteArray withSuffix(const char *description, int len, const QByteArray &suffix) {
+    QByteArray desc;
+    desc.reserve(len + suffix.size());
+    desc.append(description, len);
+    desc.append(suffix);
+    return desc;
+}
+
+QByteArray PortLabels::portDescription(const QByteArray &description, int available, bool internal) {
+    if (!initialized)
+        init();
+
+    if (available == PA_PORT_AVAILABLE_YES)
+        return withSuffix(description.constData(), description.size(), pluggedIn);
+    if (available == PA_PORT_AVAILABLE_NO)
+        return withSuffix(description.constData(), description.size(), internal ? unavailable : unplugged);
+
+    return description;
+}
+
+QByteArray PortLabels::profileDescription(const char *description, bool isUnplugged, bool isAvailable) {
+    if (!initialized)
+        init();
+
+    const int len = strlen(description);
+    QByteArray desc;
+    desc.reserve(len + (isUnplugged ? unplugged.size() : 0) + (isAvailable ? 0 : unavailable.size()));
+    desc.append(description, len);
+    if (isUnplugged)
+        desc.append(unplugged);
+    if (!isAvailable)
+        desc.append(unavailable);
+    return desc;
+}
@@ -0,0 +1,43 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef portlabels_h
+#define portlabels_h
+
+#include <QByteArray>
+
+// Composes the port and profile descriptions shown in the device and card
+// combo boxes. The translated availability suffixes are resolved once, as
+// UTF-8, by init(); call it again if the installed translators change.
+class PortLabels {
+public:
+    static void init();
+
+    // Ports that are built into the device report "unavailable" rather than "unplugged".
+    static bool isInternalPort(const char *name);
+
+    static QByteArray portDescription(const QByteArray &description, int available, bool internal);
+    static QByteArray profileDescription(const char *description, bool isUnplugged, bool isAvailable);
+
+private:
+    static bool initialized;
+    static QByteArray pluggedIn;
+    static QByteArray unplugged;
+    static QByteArray unavailable;
+};
+
+#endif
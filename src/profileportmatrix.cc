@@ -0,0 +1,72 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "profileportmatrix.h"
+
+void ProfilePortMatrix::build(const pa_card_info &info) {
+    int rows = 0;
+
+    mRowByName.clear();
+    for (pa_card_profile_info2 ** p_profile = info.profiles2; p_profile && *p_profile != nullptr; ++p_profile, ++rows)
+        mRowByName.emplace((*p_profile)->name, rows);
+
+    mWords = (info.n_ports + 63) / 64;
+    mBits.assign(rows * mWords, 0);
+    mUnplugged.assign(mWords, 0);
+
+    for (uint32_t i = 0; i < info.n_ports; ++i) {
+        const size_t word = i / 64;
+        const uint64_t bit = uint64_t(1) << (i % 64);
+
+        if (info.ports[i]->available == PA_PORT_AVAILABLE_NO)
+            mUnplugged[word] |= bit;
+
+        /* A port's profiles2 entries name profiles of the same card */
+        for (pa_card_profile_info2 ** p_profile = info.ports[i]->profiles2; p_profile && *p_profile != nullptr; ++p_profile) {
+            auto it = mRowByName.find((*p_profile)->name);
+            if (it != mRowByName.end())
+                mBits[it->second * mWords + word] |= bit;
+        }
+    }
+}
+
+int ProfilePortMatrix::row(const pa_card_profile_info2 *profile) const {
+    if (!profile || !profile->name)
+        return -1;
+
+    auto it = mRowByName.find(profile->name);
+    return it != mRowByName.end() ? it->second : -1;
+}
+
+bool ProfilePortMatrix::allPortsUnplugged(int row) const {
+    bool hasUnplugged = false;
+
+    if (row < 0)
+        return false;
+
+    const uint64_t *bits = mBits.data() + row * mWords;
+    for (size_t w = 0; w < mWords; ++w) {
+        if (bits[w] & ~mUnplugged[w])
+            return false;
+        hasUnplugged = hasUnplugged || (bits[w] & mUnplugged[w]);
+    }
+    return hasUnplugged;
+}
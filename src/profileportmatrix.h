@@ -0,0 +1,49 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef profileportmatrix_h
+#define profileportmatrix_h
+
+#include <pulse/introspect.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The ports of a card that each of its profiles uses, as one row of bits per
+// profile (in pa_card_info::profiles2 order) and one column per port (in
+// pa_card_info::ports order), plus the set of ports that are unplugged.
+// It is rebuilt from scratch on every card update; the buffers are reused.
+class ProfilePortMatrix {
+public:
+    void build(const pa_card_info &info);
+
+    // the row of a profile of the card, looked up by name, or -1
+    int row(const pa_card_profile_info2 *profile) const;
+
+    // true when the profile has ports and all of them are unplugged
+    bool allPortsUnplugged(int row) const;
+
+private:
+    size_t mWords = 0;
+    std::vector<uint64_t> mBits;
+    std::vector<uint64_t> mUnplugged;
+    // owns its keys: the pa_card_info passed to build() doesn't outlive the call
+    std::unordered_map<std::string, int> mRowByName;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #endif
 
 #include "rolewidget.h"
+#include "operationstats.h"
 
 #include <pulse/ext-stream-restore.h>
 
@@ -38,14 +39,14 @@ RoleWidget::RoleWidget(MainWindow *parent) :
 void RoleWidget::onMuteToggleButton() {
     StreamWidget::onMuteToggleButton();
 
-    executeVolumeUpdate();
+    requestVolumeUpdate();
 }
 
-void RoleWidget::executeVolumeUpdate() {
+pa_operation *RoleWidget::executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata) {
     pa_ext_stream_restore_info info;
 
     if (updating)
-        return;
+        return nullptr;
 
     info.name = role.constData();
     info.channel_map.channels = 1;
@@ -55,11 +56,13 @@ void RoleWidget::executeVolumeUpdate() {
     info.mute = muteToggleButton->isChecked();
 
     pa_operation* o;
-    if (!(o = pa_ext_stream_restore_write(get_context(), PA_UPDATE_REPLACE, &info, 1, TRUE, nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::StreamRestore, cb, userdata);
+    if (!(o = pa_ext_stream_restore_write(get_context(), PA_UPDATE_REPLACE, &info, 1, TRUE, t.callback(), t.userdata()))) {
         show_error(tr("pa_ext_stream_restore_write() failed").toUtf8().constData());
-        return;
+        return nullptr;
     }
 
-    pa_operation_unref(o);
+    t.attach(o);
+    return o;
 }
 
@@ -34,7 +34,7 @@ public:
     QByteArray device;
 
     virtual void onMuteToggleButton();
-    virtual void executeVolumeUpdate();
+    virtual pa_operation *executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata);
 };
 
 #endif
@@ -0,0 +1,195 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "searchindex.h"
+#include <algorithm>
+
+static inline uint64_t trigram(const QChar *c) {
+    return (uint64_t(c[0].unicode()) << 32) | (uint64_t(c[1].unicode()) << 16) | c[2].unicode();
+}
+
+static std::vector<uint64_t> trigrams(const QString &s) {
+    std::vector<uint64_t> t;
+    if (s.size() < 3)
+        return t;
+
+    t.reserve(s.size() - 2);
+    for (int i = 0; i + 3 <= s.size(); ++i)
+        t.push_back(trigram(s.constData() + i));
+    std::sort(t.begin(), t.end());
+    t.erase(std::unique(t.begin(), t.end()), t.end());
+    return t;
+}
+
+void SearchIndex::index(Key key, Entry &e) {
+    e.folded = e.text;
+    if (e.client != UINT32_MAX) {
+        auto c = mClientNames.find(e.client);
+        if (c != mClientNames.end())
+            e.folded += QLatin1Char('\n') + c->second;
+    }
+    e.folded = e.folded.toCaseFolded();
+    e.trigrams = trigrams(e.folded);
+
+    for (uint64_t t : e.trigrams) {
+        std::vector<Key> &posting = mPostings[t];
+        posting.insert(std::lower_bound(posting.begin(), posting.end(), key), key);
+    }
+
+    evaluate(key, e);
+}
+
+void SearchIndex::unindex(Key key, const Entry &e) {
+    for (uint64_t t : e.trigrams) {
+        auto p = mPostings.find(t);
+        if (p == mPostings.end())
+            continue;
+
+        std::vector<Key> &posting = p->second;
+        auto it = std::lower_bound(posting.begin(), posting.end(), key);
+        if (it != posting.end() && *it == key)
+            posting.erase(it);
+        if (posting.empty())
+            mPostings.erase(p);
+    }
+
+    mMatches.erase(key);
+}
+
+void SearchIndex::evaluate(Key key, const Entry &e) {
+    if (!isFiltering())
+        return;
+
+    if (e.folded.contains(mQuery))
+        mMatches.insert(key);
+    else
+        mMatches.erase(key);
+}
+
+bool SearchIndex::set(Kind kind, uint32_t index, const QString &text, uint32_t client) {
+    const Key k = key(kind, index);
+    auto it = mEntries.find(k);
+
+    if (it != mEntries.end()) {
+        /* Most updates are volume or mute changes */
+        if (it->second.text == text && it->second.client == client)
+            return false;
+        unindex(k, it->second);
+    } else
+        it = mEntries.emplace(k, Entry()).first;
+
+    const bool matched = mMatches.count(k);
+    it->second.text = text;
+    it->second.client = client;
+    this->index(k, it->second);
+    return isFiltering() && matched != (mMatches.count(k) > 0);
+}
+
+void SearchIndex::remove(Kind kind, uint32_t index) {
+    const Key k = key(kind, index);
+    auto it = mEntries.find(k);
+
+    if (it == mEntries.end())
+        return;
+
+    unindex(k, it->second);
+    mEntries.erase(it);
+}
+
+bool SearchIndex::setClientName(uint32_t client, const QString &name) {
+    auto c = mClientNames.find(client);
+    if (c != mClientNames.end() && c->second == name)
+        return false;
+    mClientNames[client] = name;
+
+    bool changed = false;
+    for (auto &e : mEntries) {
+        if (e.second.client == client) {
+            const bool matched = mMatches.count(e.first);
+            unindex(e.first, e.second);
+            index(e.first, e.second);
+            changed = changed || matched != (mMatches.count(e.first) > 0);
+        }
+    }
+    return isFiltering() && changed;
+}
+
+void SearchIndex::removeClient(uint32_t client) {
+    mClientNames.erase(client);
+}
+
+void SearchIndex::clear() {
+    mEntries.clear();
+    mPostings.clear();
+    mClientNames.clear();
+    mMatches.clear();
+}
+
+void SearchIndex::setQuery(const QString &query) {
+    const QString q = query.trimmed().toCaseFolded();
+    if (q == mQuery)
+        return;
+
+    const bool refines = isFiltering() && q.contains(mQuery);
+    mQuery = q;
+
+    if (!isFiltering()) {
+        mMatches.clear();
+        return;
+    }
+
+    std::vector<Key> candidates;
+
+    if (refines) {
+        /* Typing on: only the previous matches can still match */
+        candidates.assign(mMatches.begin(), mMatches.end());
+    }
+
+    if (q.size() >= 3) {
+        const std::vector<Key> *rarest = nullptr;
+        for (uint64_t t : trigrams(q)) {
+            auto p = mPostings.find(t);
+            if (p == mPostings.end()) {
+                mMatches.clear();
+                return;
+            }
+            if (!rarest || p->second.size() < rarest->size())
+                rarest = &p->second;
+        }
+        if (!refines || rarest->size() < candidates.size())
+            candidates = *rarest;
+    } else if (!refines) {
+        candidates.reserve(mEntries.size());
+        for (const auto &e : mEntries)
+            candidates.push_back(e.first);
+    }
+
+    mMatches.clear();
+    for (Key k : candidates) {
+        auto it = mEntries.find(k);
+        if (it != mEntries.end() && it->second.folded.contains(q))
+            mMatches.insert(k);
+    }
+}
+
+bool SearchIndex::matches(Kind kind, uint32_t index) const {
+    return !isFiltering() || mMatches.count(key(kind, index));
+}
@@ -0,0 +1,78 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef searchindex_h
+#define searchindex_h
+
+#include <QString>
+#include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Substring search over the cards, devices and streams shown in the main
+// window. Every entry is indexed by the trigrams of its case-folded text, so
+// a query only has to verify the entries in its rarest trigram's posting list
+// (queries shorter than three characters scan all entries). The set of matches
+// is kept up to date as entries are added, changed or removed, and a query
+// that refines the previous one only re-checks the previous matches.
+class SearchIndex {
+public:
+    enum Kind { Card, Sink, Source, SinkInput, SourceOutput };
+
+    // text holds the searchable fields separated by newlines; streams also
+    // match on the name of their client, when known.
+    // set() and setClientName() return whether that changed what the current query matches
+    bool set(Kind kind, uint32_t index, const QString &text, uint32_t client = UINT32_MAX);
+    void remove(Kind kind, uint32_t index);
+
+    bool setClientName(uint32_t client, const QString &name);
+    void removeClient(uint32_t client);
+
+    void clear();
+
+    void setQuery(const QString &query);
+    bool isFiltering() const { return !mQuery.isEmpty(); }
+
+    // whether the entry matches the current query; everything matches an empty one
+    bool matches(Kind kind, uint32_t index) const;
+
+private:
+    typedef uint64_t Key;
+
+    struct Entry {
+        QString text;
+        uint32_t client;
+        QString folded;
+        std::vector<uint64_t> trigrams;
+    };
+
+    static Key key(Kind kind, uint32_t index) { return (Key(kind) << 32) | index; }
+
+    void index(Key key, Entry &e);
+    void unindex(Key key, const Entry &e);
+    void evaluate(Key key, const Entry &e);
+
+    std::unordered_map<Key, Entry> mEntries;
+    std::unordered_map<uint64_t, std::vector<Key> > mPostings;
+    std::unordered_map<uint32_t, QString> mClientNames;
+
+    QString mQuery;
+    std::unordered_set<Key> mMatches;
+};
+
+#endif
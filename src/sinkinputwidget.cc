@@ -25,12 +25,14 @@
 #include "sinkinputwidget.h"
 #include "mainwindow.h"
 #include "sinkwidget.h"
-#include <QMenu>
+#include "devicemenu.h"
+#include "operationstats.h"
+#include "fadescheduler.h"
+#include "changehistory.h"
 
 
 SinkInputWidget::SinkInputWidget(MainWindow *parent) :
-    StreamWidget(parent),
-    menu{new QMenu{this}} {
+    StreamWidget(parent) {
 
     gchar *txt;
     directionLabel->setText(QString::fromUtf8(txt = g_markup_printf_escaped("<i>%s</i>", tr("on").toUtf8().constData())));
@@ -56,15 +58,46 @@ uint32_t SinkInputWidget::sinkIndex() {
     return mSinkIndex;
 }
 
-void SinkInputWidget::executeVolumeUpdate() {
+pa_operation *SinkInputWidget::executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata) {
     pa_operation* o;
 
-    if (!(o = pa_context_set_sink_input_volume(get_context(), index, &volume, nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::SetVolume, cb, userdata);
+    if (!(o = pa_context_set_sink_input_volume(get_context(), index, &volume, t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_sink_input_volume() failed").toUtf8().constData());
-        return;
+        return nullptr;
     }
 
-    pa_operation_unref(o);
+    t.attach(o);
+    return o;
+}
+
+void SinkInputWidget::fadeVolume(const pa_cvolume &v, int durationMs) {
+    FadeScheduler::instance()->fade(FadeScheduler::SinkInput, index, volume, v, durationMs);
+}
+
+void SinkInputWidget::cancelFade() {
+    FadeScheduler::instance()->cancel(FadeScheduler::SinkInput, index);
+}
+
+void SinkInputWidget::recordVolume(const pa_cvolume &before, const pa_cvolume &after) {
+    ChangeHistory::instance()->recordVolume(ChangeHistory::SinkInput, index, before, after);
+}
+
+pa_operation *SinkInputWidget::muteOperation(bool mute, pa_context_success_cb_t cb, void *userdata) {
+    pa_operation* o;
+
+    OperationStats::Tracker t(OperationStats::SetMute, cb, userdata);
+    if (!(o = pa_context_set_sink_input_mute(get_context(), index, mute, t.callback(), t.userdata()))) {
+        show_error(tr("pa_context_set_sink_input_mute() failed").toUtf8().constData());
+        return nullptr;
+    }
+
+    t.attach(o);
+    return o;
+}
+
+void SinkInputWidget::recordMute(bool before, bool after) {
+    ChangeHistory::instance()->recordMute(ChangeHistory::SinkInput, index, before, after);
 }
 
 void SinkInputWidget::onMuteToggleButton() {
@@ -73,52 +106,51 @@ void SinkInputWidget::onMuteToggleButton() {
     if (updating)
         return;
 
-    pa_operation* o;
-    if (!(o = pa_context_set_sink_input_mute(get_context(), index, muteToggleButton->isChecked(), nullptr, nullptr))) {
-        show_error(tr("pa_context_set_sink_input_mute() failed").toUtf8().constData());
-        return;
-    }
+    /* the click has flipped the button */
+    const bool mute = muteToggleButton->isChecked();
+    recordMute(!mute, mute);
 
-    pa_operation_unref(o);
+    pa_operation* o;
+    if ((o = muteOperation(mute, nullptr, nullptr)))
+        pa_operation_unref(o);
 }
 
 void SinkInputWidget::onKill() {
     pa_operation* o;
-    if (!(o = pa_context_kill_sink_input(get_context(), index, nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::Kill);
+    if (!(o = pa_context_kill_sink_input(get_context(), index, t.callback(), t.userdata()))) {
         show_error(tr("pa_context_kill_sink_input() failed").toUtf8().constData());
         return;
     }
 
+    t.attach(o);
     pa_operation_unref(o);
 }
 
-void SinkInputWidget::buildMenu() {
-  for (auto & sinkWidget : mpMainWindow->sinkWidgets) {
-      menu->addAction(new SinkMenuItem{this, sinkWidget.second->description.constData(), sinkWidget.second->index, sinkWidget.second->index == mSinkIndex, menu});
-  }
-}
+pa_operation *SinkInputWidget::moveOperation(uint32_t idx, pa_context_success_cb_t cb, void *userdata) {
+    pa_operation* o;
 
-void SinkInputWidget::SinkMenuItem::onToggle() {
-  if (widget->updating)
-    return;
+    ChangeHistory::instance()->recordMove(ChangeHistory::SinkInput, index, mSinkIndex, idx);
 
-  if (!isChecked())
-    return;
+    OperationStats::Tracker t(OperationStats::MoveStream, cb, userdata);
+    if (!(o = pa_context_move_sink_input_by_index(get_context(), index, idx, t.callback(), t.userdata()))) {
+        show_error(tr("pa_context_move_sink_input_by_index() failed").toUtf8().constData());
+        return nullptr;
+    }
 
-  /*if (!mpMainWindow->sinkWidgets.count(widget->index))
-    return;*/
+    t.attach(o);
+    return o;
+}
 
-  pa_operation* o;
-  if (!(o = pa_context_move_sink_input_by_index(get_context(), widget->index, index, nullptr, nullptr))) {
-    show_error(tr("pa_context_move_sink_input_by_index() failed").toUtf8().constData());
-    return;
-  }
+void SinkInputWidget::moveToDevice(uint32_t idx) {
+    if (updating || idx == mSinkIndex)
+        return;
 
-  pa_operation_unref(o);
+    pa_operation* o;
+    if ((o = moveOperation(idx, nullptr, nullptr)))
+        pa_operation_unref(o);
 }
 
 void SinkInputWidget::onDeviceChangePopup() {
-    menu->clear();
-    buildMenu();
-    menu->popup(QCursor::pos());
+    mpMainWindow->sinkMenu->popupFor(this, mSinkIndex);
 }
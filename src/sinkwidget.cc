@@ -23,6 +23,10 @@
 #endif
 
 #include "sinkwidget.h"
+#include "mainwindow.h"
+#include "operationstats.h"
+#include "fadescheduler.h"
+#include "changehistory.h"
 
 // #include <canberra-gtk.h>
 #if HAVE_EXT_DEVICE_RESTORE_API
@@ -75,14 +79,28 @@ SinkWidget::SinkWidget(MainWindow *parent) :
 
 }
 
-void SinkWidget::executeVolumeUpdate() {
+pa_operation *SinkWidget::executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata) {
     pa_operation* o;
-    if (!(o = pa_context_set_sink_volume_by_index(get_context(), index, &volume, nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::SetVolume, cb, userdata);
+    if (!(o = pa_context_set_sink_volume_by_index(get_context(), index, &volume, t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_sink_volume_by_index() failed").toUtf8().constData());
-        return;
+        return nullptr;
     }
 
-    pa_operation_unref(o);
+    t.attach(o);
+    return o;
+}
+
+void SinkWidget::fadeVolume(const pa_cvolume &v, int durationMs) {
+    FadeScheduler::instance()->fade(FadeScheduler::Sink, index, volume, v, durationMs);
+}
+
+void SinkWidget::cancelFade() {
+    FadeScheduler::instance()->cancel(FadeScheduler::Sink, index);
+}
+
+void SinkWidget::recordVolume(const pa_cvolume &before, const pa_cvolume &after) {
+    ChangeHistory::instance()->recordVolume(ChangeHistory::Sink, index, before, after);
 }
 
 void SinkWidget::onMuteToggleButton() {
@@ -91,12 +109,17 @@ void SinkWidget::onMuteToggleButton() {
     if (updating)
         return;
 
+    const bool mute = muteToggleButton->isChecked();
+    ChangeHistory::instance()->recordMute(ChangeHistory::Sink, index, !mute, mute);
+
     pa_operation* o;
-    if (!(o = pa_context_set_sink_mute_by_index(get_context(), index, muteToggleButton->isChecked(), nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::SetMute);
+    if (!(o = pa_context_set_sink_mute_by_index(get_context(), index, muteToggleButton->isChecked(), t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_sink_mute_by_index() failed").toUtf8().constData());
         return;
     }
 
+    t.attach(o);
     pa_operation_unref(o);
 }
 
@@ -106,10 +129,14 @@ void SinkWidget::onDefaultToggleButton() {
     if (updating)
         return;
 
-    if (!(o = pa_context_set_default_sink(get_context(), name.constData(), nullptr, nullptr))) {
+    ChangeHistory::instance()->recordDefault(ChangeHistory::Sink, mpMainWindow->defaultSinkName, name);
+
+    OperationStats::Tracker t(OperationStats::SetDefault);
+    if (!(o = pa_context_set_default_sink(get_context(), name.constData(), t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_default_sink() failed").toUtf8().constData());
         return;
     }
+    t.attach(o);
     pa_operation_unref(o);
 }
 
@@ -122,11 +149,15 @@ void SinkWidget::onPortChange() {
         pa_operation* o;
         QByteArray port = portList->itemData(sel).toString().toUtf8();
 
-        if (!(o = pa_context_set_sink_port_by_index(get_context(), index, port.constData(), nullptr, nullptr))) {
+        ChangeHistory::instance()->recordPort(ChangeHistory::Sink, index, activePort, port);
+
+        OperationStats::Tracker t(OperationStats::SetPort);
+        if (!(o = pa_context_set_sink_port_by_index(get_context(), index, port.constData(), t.callback(), t.userdata()))) {
             show_error(tr("pa_context_set_sink_port_by_index() failed").toUtf8().constData());
             return;
         }
 
+        t.attach(o);
         pa_operation_unref(o);
     }
 }
@@ -162,13 +193,15 @@ void SinkWidget::onEncodingsChange() {
         }
     }
 
-    if (!(o = pa_ext_device_restore_save_formats(get_context(), PA_DEVICE_TYPE_SINK, index, n_formats, formats, nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::DeviceRestore);
+    if (!(o = pa_ext_device_restore_save_formats(get_context(), PA_DEVICE_TYPE_SINK, index, n_formats, formats, t.callback(), t.userdata()))) {
         show_error(tr("pa_ext_device_restore_save_sink_formats() failed").toUtf8().constData());
         free(formats);
         return;
     }
 
     free(formats);
+    t.attach(o);
     pa_operation_unref(o);
 #endif
 }
@@ -52,7 +52,10 @@ public:
 #endif
 
     virtual void onMuteToggleButton();
-    virtual void executeVolumeUpdate();
+    virtual pa_operation *executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata);
+    void fadeVolume(const pa_cvolume &v, int durationMs) override;
+    void cancelFade() override;
+    void recordVolume(const pa_cvolume &before, const pa_cvolume &after) override;
     virtual void onDefaultToggleButton();
     void setDigital(bool);
 
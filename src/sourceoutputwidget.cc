@@ -25,12 +25,13 @@
 #include "sourceoutputwidget.h"
 #include "mainwindow.h"
 #include "sourcewidget.h"
-#include <QMenu>
+#include "devicemenu.h"
+#include "operationstats.h"
+#include "fadescheduler.h"
+#include "changehistory.h"
 
 SourceOutputWidget::SourceOutputWidget(MainWindow *parent) :
-    StreamWidget(parent),
-    menu{new QMenu{this}}
-{
+    StreamWidget(parent) {
 
     gchar *txt = g_markup_printf_escaped("<i>%s</i>", tr("from").toUtf8().constData());
     directionLabel->setText(QString::fromUtf8(static_cast<char*>(txt)));
@@ -64,15 +65,46 @@ uint32_t SourceOutputWidget::sourceIndex() {
 }
 
 #if HAVE_SOURCE_OUTPUT_VOLUMES
-void SourceOutputWidget::executeVolumeUpdate() {
+pa_operation *SourceOutputWidget::executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata) {
     pa_operation* o;
 
-    if (!(o = pa_context_set_source_output_volume(get_context(), index, &volume, nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::SetVolume, cb, userdata);
+    if (!(o = pa_context_set_source_output_volume(get_context(), index, &volume, t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_source_output_volume() failed").toUtf8().constData());
-        return;
+        return nullptr;
     }
 
-    pa_operation_unref(o);
+    t.attach(o);
+    return o;
+}
+
+void SourceOutputWidget::fadeVolume(const pa_cvolume &v, int durationMs) {
+    FadeScheduler::instance()->fade(FadeScheduler::SourceOutput, index, volume, v, durationMs);
+}
+
+void SourceOutputWidget::cancelFade() {
+    FadeScheduler::instance()->cancel(FadeScheduler::SourceOutput, index);
+}
+
+void SourceOutputWidget::recordVolume(const pa_cvolume &before, const pa_cvolume &after) {
+    ChangeHistory::instance()->recordVolume(ChangeHistory::SourceOutput, index, before, after);
+}
+
+pa_operation *SourceOutputWidget::muteOperation(bool mute, pa_context_success_cb_t cb, void *userdata) {
+    pa_operation* o;
+
+    OperationStats::Tracker t(OperationStats::SetMute, cb, userdata);
+    if (!(o = pa_context_set_source_output_mute(get_context(), index, mute, t.callback(), t.userdata()))) {
+        show_error(tr("pa_context_set_source_output_mute() failed").toUtf8().constData());
+        return nullptr;
+    }
+
+    t.attach(o);
+    return o;
+}
+
+void SourceOutputWidget::recordMute(bool before, bool after) {
+    ChangeHistory::instance()->recordMute(ChangeHistory::SourceOutput, index, before, after);
 }
 
 void SourceOutputWidget::onMuteToggleButton() {
@@ -81,55 +113,53 @@ void SourceOutputWidget::onMuteToggleButton() {
     if (updating)
         return;
 
-    pa_operation* o;
-    if (!(o = pa_context_set_source_output_mute(get_context(), index, muteToggleButton->isChecked(), nullptr, nullptr))) {
-        show_error(tr("pa_context_set_source_output_mute() failed").toUtf8().constData());
-        return;
-    }
+    /* the click has flipped the button */
+    const bool mute = muteToggleButton->isChecked();
+    recordMute(!mute, mute);
 
-    pa_operation_unref(o);
+    pa_operation* o;
+    if ((o = muteOperation(mute, nullptr, nullptr)))
+        pa_operation_unref(o);
 }
 #endif
 
 void SourceOutputWidget::onKill() {
     pa_operation* o;
-    if (!(o = pa_context_kill_source_output(get_context(), index, nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::Kill);
+    if (!(o = pa_context_kill_source_output(get_context(), index, t.callback(), t.userdata()))) {
         show_error(tr("pa_context_kill_source_output() failed").toUtf8().constData());
         return;
     }
 
+    t.attach(o);
     pa_operation_unref(o);
 }
 
+pa_operation *SourceOutputWidget::moveOperation(uint32_t idx, pa_context_success_cb_t cb, void *userdata) {
+    pa_operation* o;
 
-void SourceOutputWidget::buildMenu() {
-  for (auto & sourceWidget : mpMainWindow->sourceWidgets) {
-      menu->addAction(new SourceMenuItem{this, sourceWidget.second->description.constData(), sourceWidget.second->index, sourceWidget.second->index == mSourceIndex, menu});
-  }
-}
-
-void SourceOutputWidget::SourceMenuItem::onToggle() {
+    ChangeHistory::instance()->recordMove(ChangeHistory::SourceOutput, index, mSourceIndex, idx);
 
-  if (widget->updating)
-    return;
+    OperationStats::Tracker t(OperationStats::MoveStream, cb, userdata);
+    if (!(o = pa_context_move_source_output_by_index(get_context(), index, idx, t.callback(), t.userdata()))) {
+        show_error(tr("pa_context_move_source_output_by_index() failed").toUtf8().constData());
+        return nullptr;
+    }
 
-  if (!isChecked())
-    return;
+    t.attach(o);
+    return o;
+}
 
-  /*if (!mpMainWindow->sourceWidgets.count(widget->index))
-    return;*/
 
-  pa_operation* o;
-  if (!(o = pa_context_move_source_output_by_index(get_context(), widget->index, index, nullptr, nullptr))) {
-    show_error(tr("pa_context_move_source_output_by_index() failed").toUtf8().constData());
-    return;
-  }
+void SourceOutputWidget::moveToDevice(uint32_t idx) {
+    if (updating || idx == mSourceIndex)
+        return;
 
-  pa_operation_unref(o);
+    pa_operation* o;
+    if ((o = moveOperation(idx, nullptr, nullptr)))
+        pa_operation_unref(o);
 }
 
 void SourceOutputWidget::onDeviceChangePopup() {
-    menu->clear();
-    buildMenu();
-    menu->popup(QCursor::pos());
+    mpMainWindow->sourceMenu->popupFor(this, mSourceIndex);
 }
@@ -24,10 +24,8 @@
 #include "pavucontrol.h"
 
 #include "streamwidget.h"
-#include <QAction>
 
 class MainWindow;
-class QMenu;
 
 class SourceOutputWidget : public StreamWidget {
     Q_OBJECT
@@ -41,40 +39,21 @@ public:
     void setSourceIndex(uint32_t idx);
     uint32_t sourceIndex();
 #if HAVE_SOURCE_OUTPUT_VOLUMES
-    virtual void executeVolumeUpdate();
+    virtual pa_operation *executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata);
+    void fadeVolume(const pa_cvolume &v, int durationMs) override;
+    void cancelFade() override;
+    void recordVolume(const pa_cvolume &before, const pa_cvolume &after) override;
+    virtual pa_operation *muteOperation(bool mute, pa_context_success_cb_t cb, void *userdata);
+    void recordMute(bool before, bool after) override;
     virtual void onMuteToggleButton();
 #endif
     virtual void onDeviceChangePopup();
+    virtual void moveToDevice(uint32_t idx);
+    virtual pa_operation *moveOperation(uint32_t idx, pa_context_success_cb_t cb, void *userdata);
     virtual void onKill();
 
 private:
     uint32_t mSourceIndex;
-
-    void clearMenu();
-    void buildMenu();
-
-    QMenu * menu;
-
-    struct SourceMenuItem : public QAction
-    {
-        SourceMenuItem(SourceOutputWidget *w
-                , const char *label
-                , uint32_t i
-                , bool active
-                , QObject * parent = nullptr)
-            : QAction{QString::fromUtf8(label), parent}
-            , widget(w)
-            , index(i)
-        {
-            setCheckable(true);
-            setChecked(active);
-            connect(this, &QAction::toggled, [this] { onToggle(); });
-        }
-
-        SourceOutputWidget *widget;
-        uint32_t index;
-        void onToggle();
-    };
 };
 
 #endif
@@ -23,20 +23,38 @@
 #endif
 
 #include "sourcewidget.h"
+#include "mainwindow.h"
+#include "operationstats.h"
+#include "fadescheduler.h"
+#include "changehistory.h"
 
 SourceWidget::SourceWidget(MainWindow *parent) :
     DeviceWidget(parent, "source") {
 }
 
-void SourceWidget::executeVolumeUpdate() {
+pa_operation *SourceWidget::executeVolumeUpdate(pa_context_success_cb_t cb, void *userdata) {
     pa_operation* o;
 
-    if (!(o = pa_context_set_source_volume_by_index(get_context(), index, &volume, nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::SetVolume, cb, userdata);
+    if (!(o = pa_context_set_source_volume_by_index(get_context(), index, &volume, t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_source_volume_by_index() failed").toUtf8().constData());
-        return;
+        return nullptr;
     }
 
-    pa_operation_unref(o);
+    t.attach(o);
+    return o;
+}
+
+void SourceWidget::fadeVolume(const pa_cvolume &v, int durationMs) {
+    FadeScheduler::instance()->fade(FadeScheduler::Source, index, volume, v, durationMs);
+}
+
+void SourceWidget::cancelFade() {
+    FadeScheduler::instance()->cancel(FadeScheduler::Source, index);
+}
+
+void SourceWidget::recordVolume(const pa_cvolume &before, const pa_cvolume &after) {
+    ChangeHistory::instance()->recordVolume(ChangeHistory::Source, index, before, after);
 }
 
 void SourceWidget::onMuteToggleButton() {
@@ -45,12 +63,17 @@ void SourceWidget::onMuteToggleButton() {
     if (updating)
         return;
 
+    const bool mute = muteToggleButton->isChecked();
+    ChangeHistory::instance()->recordMute(ChangeHistory::Source, index, !mute, mute);
+
     pa_operation* o;
-    if (!(o = pa_context_set_source_mute_by_index(get_context(), index, muteToggleButton->isChecked(), nullptr, nullptr))) {
+    OperationStats::Tracker t(OperationStats::SetMute);
+    if (!(o = pa_context_set_source_mute_by_index(get_context(), index, muteToggleButton->isChecked(), t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_source_mute_by_index() failed").toUtf8().constData());
         return;
     }
 
+    t.attach(o);
     pa_operation_unref(o);
 }
 
@@ -60,10 +83,14 @@ void SourceWidget::onDefaultToggleButton() {
     if (updating)
         return;
 
-    if (!(o = pa_context_set_default_source(get_context(), name.constData(), nullptr, nullptr))) {
+    ChangeHistory::instance()->recordDefault(ChangeHistory::Source, mpMainWindow->defaultSourceName, name);
+
+    OperationStats::Tracker t(OperationStats::SetDefault);
+    if (!(o = pa_context_set_default_source(get_context(), name.constData(), t.callback(), t.userdata()))) {
         show_error(tr("pa_context_set_default_source() failed").toUtf8().constData());
         return;
     }
+    t.attach(o);
     pa_operation_unref(o);
 }
 
@@ -76,11 +103,15 @@ void SourceWidget::onPortChange() {
         pa_operation* o;
         QByteArray port = portList->itemData(current).toByteArray();
 
-        if (!(o = pa_context_set_source_port_by_index(get_context(), index, port.constData(), nullptr, nullptr))) {
+        ChangeHistory::instance()->recordPort(ChangeHistory::Source, index, activePort, port);
+
+        OperationStats::Tracker t(OperationStats::SetPort);
+        if (!(o = pa_context_set_source_port_by_index(get_context(), index, port.constData(), t.callback(), t.userdata()))) {
             show_error(tr("pa_context_set_source_port_by_index() failed").toUtf8().constData());
         return;
     }
 
+    t.attach(o);
     pa_operation_unref(o);
     }
 }
@@ -26,49 +26,72 @@
 #include "mainwindow.h"
 #include "channel.h"
 #include <QAction>
+#include <QMouseEvent>
+#include <QPainter>
+
+/* how long "Fade Out" takes, in ms */
+#define FADE_OUT_DURATION 2000
 
 /*** StreamWidget ***/
 StreamWidget::StreamWidget(MainWindow *parent) :
     MinimalStreamWidget(parent),
     mpMainWindow(parent),
-    terminate{new QAction{tr("Terminate"), this}} {
+    selected(false),
+    channelsCanDecibel(false),
+    channelsRow(-1),
+    baseVolume(PA_VOLUME_NORM),
+    terminate{new QAction{tr("Terminate"), this}},
+    fadeOut{new QAction{tr("Fade Out"), this}} {
 
     setupUi(this);
     initPeakProgressBar(channelsGrid);
 
-    timeout.setSingleShot(true);
-    timeout.setInterval(100);
-    connect(&timeout, &QTimer::timeout, this, &StreamWidget::timeoutEvent);
-
     connect(muteToggleButton, &QToolButton::toggled, this, &StreamWidget::onMuteToggleButton);
     connect(lockToggleButton, &QToolButton::toggled, this, &StreamWidget::onLockToggleButton);
     connect(deviceButton, &QAbstractButton::released, this, &StreamWidget::onDeviceChangePopup);
 
     connect(terminate, &QAction::triggered, this, &StreamWidget::onKill);
     addAction(terminate);
+    connect(fadeOut, &QAction::triggered, this, &StreamWidget::onFadeOut);
+    addAction(fadeOut);
     setContextMenuPolicy(Qt::ActionsContextMenu);
 
     for (auto & channel : channels)
         channel = nullptr;
+    channelMap.channels = 0;
+    pa_cvolume_init(&volume);
 }
 
 void StreamWidget::setChannelMap(const pa_channel_map &m, bool can_decibel) {
     channelMap = m;
+    channelsCanDecibel = can_decibel;
+    /* reserve one grid row per channel, in channel order */
+    channelsRow = channelsGrid->rowCount();
+
+    lockToggleButton->setEnabled(m.channels > 1);
+    hideLockedChannels(lockToggleButton->isChecked());
+}
+
+Channel *StreamWidget::channel(int i) {
+    g_assert(i < channelMap.channels);
 
-    for (int i = 0; i < m.channels; i++) {
-        Channel *ch = channels[i] = new Channel(channelsGrid);
+    if (!channels[i]) {
+        Channel *ch = channels[i] = new Channel(channelsGrid, channelsRow + i);
         ch->channel = i;
-        ch->can_decibel = can_decibel;
+        ch->can_decibel = channelsCanDecibel;
         ch->minimalStreamWidget = this;
+        ch->last = i == channelMap.channels - 1;
         char text[64];
-        snprintf(text, sizeof(text), "<b>%s</b>", pa_channel_position_to_pretty_string(m.map[i]));
+        snprintf(text, sizeof(text), "<b>%s</b>", pa_channel_position_to_pretty_string(channelMap.map[i]));
         ch->channelLabel->setText(QString::fromUtf8(text));
+        if (ch->last)
+            ch->setBaseVolume(baseVolume);
+        if (volume.channels == channelMap.channels)
+            ch->setVolume(volume.values[i]);
+        ch->setEnabled(!muteToggleButton->isChecked());
     }
-    channels[m.channels-1]->last = true;
-    channels[m.channels-1]->setBaseVolume(PA_VOLUME_NORM);
 
-    lockToggleButton->setEnabled(m.channels > 1);
-    hideLockedChannels(lockToggleButton->isChecked());
+    return channels[i];
 }
 
 void StreamWidget::setVolume(const pa_cvolume &v, bool force) {
@@ -76,9 +99,11 @@ void StreamWidget::setVolume(const pa_cvolume &v, bool force) {
 
     volume = v;
 
-    if (!timeout.isActive() || force) { /* do not update the volume when a volume change is still in flux */
-        for (int i = 0; i < volume.channels; i++)
-            channels[i]->setVolume(volume.values[i]);
+    if (!volumeUpdateInFlight() || force) { /* do not update the volume when a volume change is still in flux */
+        for (int i = 0; i < volume.channels; i++) {
+            if (channels[i])
+                channels[i]->setVolume(volume.values[i]);
+        }
     }
 }
 
@@ -93,42 +118,101 @@ void StreamWidget::updateChannelVolume(int channel, pa_volume_t v) {
     } else
         n.values[channel] = v;
 
-    setVolume(n, true);
+    applyVolume(n);
+}
 
-    if(!timeout.isActive()) {
-        timeout.start();
-    }
+void StreamWidget::applyVolume(const pa_cvolume &v) {
+    cancelFade();
+    recordVolume(volume, v);
+    setVolume(v, true);
+
+    requestVolumeUpdate();
 }
 
 void StreamWidget::hideLockedChannels(bool hide) {
-    for (int i = 0; i < channelMap.channels - 1; i++)
-        channels[i]->setVisible(!hide);
+    for (int i = 0; i < channelMap.channels - 1; i++) {
+        if (!hide)
+            channel(i)->setVisible(true);
+        else if (channels[i])
+            channels[i]->setVisible(false);
+    }
 
-    channels[channelMap.channels - 1]->channelLabel->setVisible(!hide);
+    channel(channelMap.channels - 1)->channelLabel->setVisible(!hide);
+}
+
+void StreamWidget::setVolumeTracking(bool tracking) {
+    for (int i = 0; i < channelMap.channels; i++) {
+        if (channels[i])
+            channels[i]->setTracking(tracking);
+    }
 }
 
 void StreamWidget::onMuteToggleButton() {
 
     lockToggleButton->setEnabled(!muteToggleButton->isChecked());
 
-    for (int i = 0; i < channelMap.channels; i++)
-        channels[i]->setEnabled(!muteToggleButton->isChecked());
+    for (int i = 0; i < channelMap.channels; i++) {
+        if (channels[i])
+            channels[i]->setEnabled(!muteToggleButton->isChecked());
+    }
 }
 
 void StreamWidget::onLockToggleButton() {
     hideLockedChannels(lockToggleButton->isChecked());
 }
 
-bool StreamWidget::timeoutEvent() {
-    executeVolumeUpdate();
-    return false;
+void StreamWidget::onDeviceChangePopup() {
 }
 
-void StreamWidget::executeVolumeUpdate() {
+void StreamWidget::moveToDevice(uint32_t) {
 }
 
-void StreamWidget::onDeviceChangePopup() {
+pa_operation *StreamWidget::muteOperation(bool, pa_context_success_cb_t, void *) {
+    return nullptr;
+}
+
+pa_operation *StreamWidget::moveOperation(uint32_t, pa_context_success_cb_t, void *) {
+    return nullptr;
+}
+
+void StreamWidget::recordMute(bool, bool) {
+}
+
+void StreamWidget::setSelected(bool s) {
+    if (selected == s)
+        return;
+
+    selected = s;
+    update();
+}
+
+void StreamWidget::mousePressEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::ControlModifier)) {
+        setSelected(!selected);
+        event->accept();
+        return;
+    }
+
+    MinimalStreamWidget::mousePressEvent(event);
+}
+
+void StreamWidget::paintEvent(QPaintEvent *event) {
+    MinimalStreamWidget::paintEvent(event);
+
+    if (!selected)
+        return;
+
+    QPainter painter(this);
+    painter.setPen(QPen(palette().color(QPalette::Highlight), 2));
+    painter.drawRect(rect().adjusted(1, 1, -1, -1));
 }
 
 void StreamWidget::onKill() {
 }
+
+void StreamWidget::onFadeOut() {
+    pa_cvolume v;
+
+    pa_cvolume_set(&v, volume.channels, PA_VOLUME_MUTED);
+    fadeVolume(v, FADE_OUT_DURATION);
+}
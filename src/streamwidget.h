@@ -25,7 +25,6 @@
 
 #include "minimalstreamwidget.h"
 #include "ui_streamwidget.h"
-#include <QTimer>
 
 class MainWindow;
 class Channel;
@@ -41,28 +40,54 @@ public:
     virtual void updateChannelVolume(int channel, pa_volume_t v);
 
     void hideLockedChannels(bool hide = true);
+    void setVolumeTracking(bool tracking) override;
+    const pa_cvolume &currentVolume() const override { return volume; }
+    void applyVolume(const pa_cvolume &v) override;
 
     pa_channel_map channelMap;
     pa_cvolume volume;
 
+    // identifies the stream across sessions, see MixerSnapshot::streamKey()
+    QByteArray streamKey;
+
+    /* Channels are created on demand: while the channels are locked only
+     * the last one is shown, so that is the only one we build. */
     Channel *channels[PA_CHANNELS_MAX];
+    Channel *channel(int i);
 
     virtual void onMuteToggleButton();
     virtual void onLockToggleButton();
     virtual void onDeviceChangePopup();
-    // virtual bool onContextTriggerEvent(GdkEventButton*);
+    virtual void moveToDevice(uint32_t index);
 
-    QTimer timeout;
+    /* The operations behind the mute button and the device menu, also used
+     * for bulk changes; they return null if the call could not be made. */
+    virtual pa_operation *muteOperation(bool mute, pa_context_success_cb_t cb, void *userdata);
+    virtual pa_operation *moveOperation(uint32_t index, pa_context_success_cb_t cb, void *userdata);
+    // adds a mute change made in this window to the ChangeHistory
+    virtual void recordMute(bool before, bool after);
 
-    bool timeoutEvent();
+    /* Ctrl+click toggles the selection the bulk actions work on */
+    bool isSelected() const { return selected; }
+    void setSelected(bool selected);
 
-    virtual void executeVolumeUpdate();
+    // virtual bool onContextTriggerEvent(GdkEventButton*);
     virtual void onKill();
+    void onFadeOut();
 
 protected:
+    void mousePressEvent(QMouseEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
     MainWindow* mpMainWindow;
+    bool selected;
+
+    bool channelsCanDecibel;
+    int channelsRow;
+    pa_volume_t baseVolume;
 
     QAction * terminate;
+    QAction * fadeOut;
 };
 
 #endif
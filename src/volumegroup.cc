@@ -0,0 +1,328 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "volumegroup.h"
+#include "minimalstreamwidget.h"
+#include <QHBoxLayout>
+#include <QIcon>
+#include <QInputDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QSettings>
+#include <QSlider>
+#include <QToolButton>
+#include <QVBoxLayout>
+#include <algorithm>
+
+/* the master slider goes up to the same maximum as the channel sliders */
+#define GROUP_MAX_PERCENT 153
+
+static int volumePercent(pa_volume_t v) {
+    return (int) ((double) v * 100.0 / PA_VOLUME_NORM + 0.5);
+}
+
+VolumeGroup::VolumeGroup(const QString &name, const QString &rules, QWidget *parent) :
+    QWidget(parent),
+    mName(name),
+    mBaseValue(0),
+    updating(false) {
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+
+    QVBoxLayout *labels = new QVBoxLayout;
+    mNameLabel = new QLabel(this);
+    mNameLabel->setText(QStringLiteral("<b>") + name.toHtmlEscaped() + QStringLiteral("</b>"));
+    mMembersLabel = new QLabel(this);
+    labels->addWidget(mNameLabel);
+    labels->addWidget(mMembersLabel);
+    layout->addLayout(labels, 1);
+
+    mSlider = new QSlider(Qt::Horizontal, this);
+    mSlider->setRange(0, GROUP_MAX_PERCENT);
+    mSlider->setPageStep(5);
+    layout->addWidget(mSlider, 2);
+
+    mValueLabel = new QLabel(this);
+    mValueLabel->setMinimumWidth(mValueLabel->fontMetrics().averageCharWidth() * 5);
+    mValueLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    layout->addWidget(mValueLabel);
+
+    QToolButton *edit = new QToolButton(this);
+    edit->setText(tr("Edit"));
+    edit->setToolTip(tr("Edit the rules of this group"));
+    layout->addWidget(edit);
+
+    QToolButton *remove = new QToolButton(this);
+    remove->setIcon(QIcon::fromTheme(QStringLiteral("list-remove")));
+    remove->setToolTip(tr("Remove this group"));
+    layout->addWidget(remove);
+
+    connect(mSlider, &QSlider::valueChanged, this, &VolumeGroup::onSliderChanged);
+    connect(mSlider, &QSlider::sliderReleased, this, &VolumeGroup::onSliderReleased);
+    connect(edit, &QToolButton::clicked, this, [this] { Q_EMIT editRequested(this); });
+    connect(remove, &QToolButton::clicked, this, [this] { Q_EMIT removeRequested(this); });
+
+    setRules(rules);
+}
+
+void VolumeGroup::setRules(const QString &rules) {
+    mRules = rules;
+    mParsed.clear();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const QStringList list = rules.split(QLatin1Char(';'), Qt::SkipEmptyParts);
+#else
+    const QStringList list = rules.split(QLatin1Char(';'), QString::SkipEmptyParts);
+#endif
+    for (const QString &r : list) {
+        const int eq = r.indexOf(QLatin1Char('='));
+        if (eq <= 0)
+            continue;
+
+        Rule rule;
+        rule.property = r.left(eq).trimmed().toUtf8();
+        rule.pattern = QRegExp(r.mid(eq + 1).trimmed(), Qt::CaseInsensitive, QRegExp::Wildcard);
+        mParsed.push_back(rule);
+    }
+
+    mNameLabel->setToolTip(rules);
+}
+
+bool VolumeGroup::matches(pa_proplist *proplist) const {
+    for (const Rule &rule : mParsed) {
+        const char *value = pa_proplist_gets(proplist, rule.property.constData());
+        if (value && rule.pattern.exactMatch(QString::fromUtf8(value)))
+            return true;
+    }
+
+    return false;
+}
+
+void VolumeGroup::setMember(MinimalStreamWidget *w, bool member) {
+    bool changed;
+
+    if (member)
+        changed = mMembers.insert(w).second;
+    else {
+        changed = mMembers.erase(w) > 0;
+        mBase.erase(w);
+    }
+
+    if (changed)
+        refresh();
+}
+
+void VolumeGroup::clearMembers() {
+    mMembers.clear();
+    mBase.clear();
+    refresh();
+}
+
+void VolumeGroup::memberVolumeChanged(MinimalStreamWidget *w) {
+    /* while the master slider scales the members, it is the reference */
+    if (!mBase.empty() || !mMembers.count(w))
+        return;
+
+    refresh();
+}
+
+/* The master slider shows the loudest channel of the loudest member */
+void VolumeGroup::refresh() {
+    pa_volume_t max = PA_VOLUME_MUTED;
+
+    for (MinimalStreamWidget *w : mMembers) {
+        const pa_cvolume &v = w->currentVolume();
+        if (v.channels > 0)
+            max = std::max(max, pa_cvolume_max(&v));
+    }
+
+    updating = true;
+    mSlider->setEnabled(!mMembers.empty());
+    mSlider->setValue(volumePercent(max));
+    mValueLabel->setText(tr("%1%").arg(mSlider->value()));
+    mMembersLabel->setText(tr("%n member(s)", nullptr, (int) mMembers.size()));
+    updating = false;
+}
+
+void VolumeGroup::onSliderChanged(int value) {
+    mValueLabel->setText(tr("%1%").arg(value));
+
+    if (updating)
+        return;
+
+    if (mBase.empty()) {
+        for (MinimalStreamWidget *w : mMembers)
+            mBase[w] = w->currentVolume();
+        mBaseValue = 0;
+        for (const auto &it : mBase) {
+            if (it.second.channels > 0)
+                mBaseValue = std::max(mBaseValue, volumePercent(pa_cvolume_max(&it.second)));
+        }
+    }
+
+    for (const auto &it : mBase) {
+        pa_cvolume v = it.second;
+
+        for (int i = 0; i < v.channels; i++) {
+            double scaled;
+            if (mBaseValue > 0)
+                scaled = (double) it.second.values[i] * value / mBaseValue;
+            else
+                scaled = (double) PA_VOLUME_NORM * value / 100.0;
+            v.values[i] = (pa_volume_t) std::min(scaled + 0.5, (double) PA_VOLUME_MAX);
+        }
+
+        it.first->applyVolume(v);
+    }
+
+    /* keyboard and wheel steps each scale from the volumes they start from */
+    if (!mSlider->isSliderDown())
+        mBase.clear();
+}
+
+void VolumeGroup::onSliderReleased() {
+    mBase.clear();
+}
+
+VolumeGroups::VolumeGroups(QWidget *container, QLabel *emptyLabel) :
+    QObject(container),
+    mContainer(container),
+    mEmptyLabel(emptyLabel) {
+
+    QSettings config;
+    const int n = config.beginReadArray(QStringLiteral("volumeGroups"));
+    for (int i = 0; i < n; i++) {
+        config.setArrayIndex(i);
+        addGroup(config.value(QStringLiteral("name")).toString(), config.value(QStringLiteral("rules")).toString());
+    }
+    config.endArray();
+
+    updateEmptyLabel();
+}
+
+VolumeGroups::~VolumeGroups() {
+    for (auto &it : mProplists)
+        pa_proplist_free(it.second);
+}
+
+void VolumeGroups::save() const {
+    QSettings config;
+    config.beginWriteArray(QStringLiteral("volumeGroups"), (int) mGroups.size());
+    for (size_t i = 0; i < mGroups.size(); i++) {
+        config.setArrayIndex((int) i);
+        config.setValue(QStringLiteral("name"), mGroups[i]->name());
+        config.setValue(QStringLiteral("rules"), mGroups[i]->rules());
+    }
+    config.endArray();
+}
+
+void VolumeGroups::updateEmptyLabel() {
+    mEmptyLabel->setVisible(mGroups.empty());
+}
+
+void VolumeGroups::addGroup(const QString &name, const QString &rules) {
+    VolumeGroup *group = new VolumeGroup(name, rules, mContainer);
+
+    connect(group, &VolumeGroup::editRequested, this, &VolumeGroups::editGroup);
+    connect(group, &VolumeGroup::removeRequested, this, &VolumeGroups::removeGroup);
+
+    mContainer->layout()->addWidget(group);
+    mGroups.push_back(group);
+
+    for (const auto &it : mProplists)
+        group->setMember(it.first, group->matches(it.second));
+
+    updateEmptyLabel();
+}
+
+void VolumeGroups::addGroupInteractively() {
+    bool ok;
+    const QString name = QInputDialog::getText(mContainer, tr("Add Volume Group"), tr("Name:"),
+                                               QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || name.isEmpty())
+        return;
+
+    const QString rules = QInputDialog::getText(mContainer, tr("Add Volume Group"),
+                                                tr("Rules, e.g. application.process.binary=firefox; application.name=*chrom*:"),
+                                                QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok)
+        return;
+
+    addGroup(name, rules);
+    save();
+}
+
+void VolumeGroups::editGroup(VolumeGroup *group) {
+    bool ok;
+    const QString rules = QInputDialog::getText(mContainer, tr("Edit Volume Group"), tr("Rules of %1:").arg(group->name()),
+                                                QLineEdit::Normal, group->rules(), &ok).trimmed();
+    if (!ok)
+        return;
+
+    group->setRules(rules);
+    for (const auto &it : mProplists)
+        group->setMember(it.first, group->matches(it.second));
+    save();
+}
+
+void VolumeGroups::removeGroup(VolumeGroup *group) {
+    auto it = std::find(mGroups.begin(), mGroups.end(), group);
+    if (it == mGroups.end())
+        return;
+
+    mGroups.erase(it);
+    group->deleteLater();
+    save();
+    updateEmptyLabel();
+}
+
+void VolumeGroups::updateMember(MinimalStreamWidget *w, pa_proplist *proplist) {
+    pa_proplist *&p = mProplists[w];
+    if (!p)
+        p = pa_proplist_new();
+    pa_proplist_update(p, PA_UPDATE_SET, proplist);
+
+    for (VolumeGroup *group : mGroups) {
+        group->setMember(w, group->matches(p));
+        group->memberVolumeChanged(w);
+    }
+}
+
+void VolumeGroups::removeMember(MinimalStreamWidget *w) {
+    auto it = mProplists.find(w);
+    if (it == mProplists.end())
+        return;
+
+    pa_proplist_free(it->second);
+    mProplists.erase(it);
+
+    for (VolumeGroup *group : mGroups)
+        group->setMember(w, false);
+}
+
+void VolumeGroups::clearMembers() {
+    for (auto &it : mProplists)
+        pa_proplist_free(it.second);
+    mProplists.clear();
+
+    for (VolumeGroup *group : mGroups)
+        group->clearMembers();
+}
@@ -0,0 +1,121 @@
+/***
+  This file is part of pavucontrol-qt.
+
+  pavucontrol-qt is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  pavucontrol-qt is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with pavucontrol-qt. If not, see <https://www.gnu.org/licenses/>.
+***/
+
+#ifndef volumegroup_h
+#define volumegroup_h
+
+#include "pavucontrol.h"
+#include <QRegExp>
+#include <QWidget>
+#include <map>
+#include <set>
+#include <vector>
+
+class MinimalStreamWidget;
+class QLabel;
+class QSlider;
+class QVBoxLayout;
+
+// A user-defined set of streams and devices with one master slider that
+// scales the volumes of all of them proportionally. Members are matched by
+// their proplist: the rules are separated by ';' and read "property=pattern",
+// with a case-insensitive wildcard pattern; matching any rule is enough.
+//
+// A change of the master slider sets the new volumes on all member widgets
+// before returning to the mainloop, each through the widget's own volume
+// pipeline, so a drag causes at most one request in flight per member.
+class VolumeGroup : public QWidget {
+    Q_OBJECT
+public:
+    VolumeGroup(const QString &name, const QString &rules, QWidget *parent = nullptr);
+
+    const QString &name() const { return mName; }
+    const QString &rules() const { return mRules; }
+    void setRules(const QString &rules);
+
+    bool matches(pa_proplist *proplist) const;
+
+    void setMember(MinimalStreamWidget *w, bool member);
+    void clearMembers();
+    // the volume of a member changed, on the server or in its own sliders
+    void memberVolumeChanged(MinimalStreamWidget *w);
+
+Q_SIGNALS:
+    void editRequested(VolumeGroup *group);
+    void removeRequested(VolumeGroup *group);
+
+private Q_SLOTS:
+    void onSliderChanged(int value);
+    void onSliderReleased();
+
+private:
+    struct Rule {
+        QByteArray property;
+        QRegExp pattern;
+    };
+
+    void refresh();
+
+    QString mName;
+    QString mRules;
+    std::vector<Rule> mParsed;
+
+    std::set<MinimalStreamWidget*> mMembers;
+    // the member volumes the master slider scales, while it is being moved
+    std::map<MinimalStreamWidget*, pa_cvolume> mBase;
+    int mBaseValue;
+    bool updating;
+
+    QLabel *mNameLabel;
+    QLabel *mMembersLabel;
+    QLabel *mValueLabel;
+    QSlider *mSlider;
+};
+
+// The groups shown in the Groups tab, kept in the settings file.
+class VolumeGroups : public QObject {
+    Q_OBJECT
+public:
+    VolumeGroups(QWidget *container, QLabel *emptyLabel);
+    ~VolumeGroups() override;
+
+    void addGroup(const QString &name, const QString &rules);
+
+    // (re)evaluate the membership of a widget after its proplist or volume changed
+    void updateMember(MinimalStreamWidget *w, pa_proplist *proplist);
+    void removeMember(MinimalStreamWidget *w);
+    void clearMembers();
+
+public Q_SLOTS:
+    void addGroupInteractively();
+
+private Q_SLOTS:
+    void editGroup(VolumeGroup *group);
+    void removeGroup(VolumeGroup *group);
+
+private:
+    void save() const;
+    void updateEmptyLabel();
+
+    QWidget *mContainer;
+    QLabel *mEmptyLabel;
+    std::vector<VolumeGroup*> mGroups;
+    // the proplist of every known widget, to match groups added later
+    std::map<MinimalStreamWidget*, pa_proplist*> mProplists;
+};
+
+#endif